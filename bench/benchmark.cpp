@@ -0,0 +1,207 @@
+//Copyright © 2023 Charles Kerr. All rights reserved.
+
+#include "benchmark.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <numeric>
+#include <stdexcept>
+
+#include "timer.hpp"
+#include "timestamp.hpp"
+
+using namespace std::string_literals;
+
+namespace util {
+    namespace {
+        //=================================================================================
+        auto median(std::vector<double> values) ->double {
+            if (values.empty()){
+                return 0.0 ;
+            }
+            std::sort(values.begin(), values.end());
+            auto middle = values.size() / 2 ;
+            if (values.size() % 2 == 0){
+                return (values[middle-1] + values[middle]) / 2.0 ;
+            }
+            return values[middle] ;
+        }
+        //=================================================================================
+        auto timed(const benchmark_t::batch_t &batch, std::uint64_t iterations) ->std::int64_t {
+            auto start = timer_t::ticks() ;
+            batch(iterations);
+            return timer_t::ticks() - start ;
+        }
+        //=================================================================================
+        auto escape(const std::string &text) ->std::string {
+            auto rvalue = std::string() ;
+            for (auto ch : text){
+                if ((ch == '"') || (ch == '\\')){
+                    rvalue += '\\';
+                }
+                rvalue += ch ;
+            }
+            return rvalue ;
+        }
+        //=================================================================================
+        // Reads back the medians from a file written by write(), one benchmark per line
+        auto baseline(const std::string &path) ->std::map<std::string,double> {
+            auto rvalue = std::map<std::string,double>() ;
+            auto input = std::ifstream(path);
+            if (!input.is_open()){
+                throw std::runtime_error("Unable to open: "s + path);
+            }
+            auto line = std::string() ;
+            while (std::getline(input, line)){
+                auto name = line.find("\"name\":\"");
+                auto value = line.find("\"median\":");
+                if ((name == std::string::npos) || (value == std::string::npos)){
+                    continue ;
+                }
+                name += 8 ;
+                auto end = line.find("\",", name);
+                if (end == std::string::npos){
+                    continue ;
+                }
+                rvalue[line.substr(name, end - name)] = std::stod(line.substr(value + 9));
+            }
+            return rvalue ;
+        }
+    }
+
+    //=================================================================================
+    auto benchmark_t::registry() ->std::vector<entry_t>& {
+        static std::vector<entry_t> instance ;
+        return instance ;
+    }
+
+    //=================================================================================
+    auto benchmark_t::measure(const std::string &name, const batch_t &batch, const options_t &options) ->result_t {
+        auto result = result_t() ;
+        result.name = name ;
+        // Calibrate during the warmup, growing the count until one batch fills a sample
+        auto sample_ns = std::max<std::int64_t>(options.sample_ms, 1) * 1000000 ;
+        auto iterations = std::uint64_t(1) ;
+        auto warmup = timer_t() ;
+        warmup.time(options.warmup_ms, false);
+        while (true){
+            auto duration = timed(batch, iterations);
+            if ((duration < sample_ns) && (iterations < (std::uint64_t(1) << 40))){
+                iterations *= (duration < sample_ns / 16) ? 8 : 2 ;
+            }
+            else if (warmup.expired()){
+                break ;
+            }
+        }
+        result.iterations = iterations ;
+        auto count = std::max<std::size_t>(options.samples, 1) ;
+        for (std::size_t i = 0 ; i < count ; ++i){
+            result.samples.push_back(static_cast<double>(timed(batch, iterations)) / static_cast<double>(iterations));
+        }
+        result.median = median(result.samples);
+        auto deviations = std::vector<double>() ;
+        for (auto sample : result.samples){
+            deviations.push_back(std::abs(sample - result.median));
+        }
+        result.mad = median(deviations);
+        result.mean = std::accumulate(result.samples.begin(), result.samples.end(), 0.0) / static_cast<double>(count);
+        // Order statistics that bracket the median with 95% confidence
+        auto sorted = result.samples ;
+        std::sort(sorted.begin(), sorted.end());
+        auto spread = 1.96 * std::sqrt(static_cast<double>(count)) / 2.0 ;
+        auto low = std::floor(static_cast<double>(count) / 2.0 - spread) ;
+        auto high = std::ceil(static_cast<double>(count) / 2.0 + spread) ;
+        result.low = sorted[static_cast<std::size_t>(std::max(low, 0.0))] ;
+        result.high = sorted[std::min(static_cast<std::size_t>(std::max(high, 0.0)), count - 1)] ;
+        return result ;
+    }
+    //=================================================================================
+    auto benchmark_t::write(const std::vector<result_t> &results, const std::string &path) ->void {
+        auto output = std::ofstream(path);
+        if (!output.is_open()){
+            throw std::runtime_error("Unable to create: "s + path);
+        }
+        char date[timestamp_t::max_size] ;
+        auto length = timestamp_t::format(date, sizeof(date), timestamp_t::precision_t::seconds, true);
+        output << "{\"date\":\"" << std::string(date, length) << "\",\"unit\":\"ns\",\"benchmarks\":[\n" << std::setprecision(9);
+        for (std::size_t i = 0 ; i < results.size() ; ++i){
+            const auto &result = results[i] ;
+            output << "{\"name\":\"" << escape(result.name) << "\",\"median\":" << result.median
+            << ",\"mad\":" << result.mad << ",\"mean\":" << result.mean
+            << ",\"ci_low\":" << result.low << ",\"ci_high\":" << result.high
+            << ",\"iterations\":" << result.iterations << ",\"samples\":[";
+            for (std::size_t j = 0 ; j < result.samples.size() ; ++j){
+                output << (j == 0 ? "" : ",") << result.samples[j] ;
+            }
+            output << "]}" << (i + 1 < results.size() ? ",\n" : "\n");
+        }
+        output << "]}\n";
+    }
+    //=================================================================================
+    auto benchmark_t::run(int argc, char *argv[]) ->int {
+        auto options = options_t() ;
+        try {
+            for (auto i = 1 ; i < argc ; ++i){
+                auto arg = std::string(argv[i]) ;
+                if (i + 1 >= argc){
+                    throw std::runtime_error("Missing value for: "s + arg);
+                }
+                auto value = std::string(argv[++i]) ;
+                if (arg == "--filter"){
+                    options.filter = value ;
+                }
+                else if (arg == "--samples"){
+                    options.samples = static_cast<std::size_t>(std::stoul(value));
+                }
+                else if (arg == "--sample-ms"){
+                    options.sample_ms = std::stoll(value);
+                }
+                else if (arg == "--warmup-ms"){
+                    options.warmup_ms = std::stoll(value);
+                }
+                else if (arg == "--json"){
+                    options.json = value ;
+                }
+                else if (arg == "--compare"){
+                    options.compare = value ;
+                }
+                else {
+                    throw std::runtime_error("Unknown option: "s + arg);
+                }
+            }
+            auto previous = options.compare.empty() ? std::map<std::string,double>() : baseline(options.compare) ;
+            auto results = std::vector<result_t>() ;
+            std::cout << std::left << std::setw(40) << "benchmark" << std::right << std::setw(12) << "median ns" << std::setw(10) << "mad" << std::setw(24) << "95% ci" << std::setw(14) << "iterations";
+            if (!previous.empty()){
+                std::cout << std::setw(12) << "vs base";
+            }
+            std::cout << "\n" << std::fixed << std::setprecision(2);
+            for (const auto &entry : registry()){
+                if (!options.filter.empty() && (entry.name.find(options.filter) == std::string::npos)){
+                    continue ;
+                }
+                auto result = measure(entry.name, entry.batch, options);
+                std::cout << std::left << std::setw(40) << result.name << std::right << std::setw(12) << result.median << std::setw(10) << result.mad
+                << std::setw(11) << result.low << " - " << std::setw(10) << result.high << std::setw(14) << result.iterations ;
+                auto iter = previous.find(result.name) ;
+                if ((iter != previous.end()) && (iter->second > 0.0)){
+                    std::cout << std::setw(11) << result.median / iter->second << "x" ;
+                }
+                std::cout << std::endl;
+                results.push_back(result);
+            }
+            if (!options.json.empty()){
+                write(results, options.json);
+            }
+        }
+        catch (const std::exception &e){
+            std::cerr << e.what() << std::endl;
+            return 1 ;
+        }
+        return 0 ;
+    }
+}
@@ -0,0 +1,93 @@
+//Copyright © 2023 Charles Kerr. All rights reserved.
+
+#ifndef benchmark_hpp
+#define benchmark_hpp
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace util {
+    //=================================================================================
+    // Keep the compiler from discarding a value, or from caching memory across it
+    template <typename T>
+    inline auto do_not_optimize(T const &value) ->void {
+#if defined(_MSC_VER)
+        auto volatile sink = reinterpret_cast<const volatile char*>(&value) ;
+        static_cast<void>(*sink);
+        _ReadWriteBarrier();
+#else
+        asm volatile("" : : "r,m"(value) : "memory");
+#endif
+    }
+    //=================================================================================
+    inline auto clobber() ->void {
+#if defined(_MSC_VER)
+        _ReadWriteBarrier();
+#else
+        asm volatile("" : : : "memory");
+#endif
+    }
+
+    //=================================================================================
+    /* Microbenchmark harness, timed with timer_t::ticks().
+     Each benchmark is warmed up, its iteration count calibrated so a sample lasts at least
+     the minimum sample time, then sampled repeatedly. We report the median time per
+     iteration, the median absolute deviation, and a 95% confidence interval of the median
+     (from order statistics, so no assumption of normal noise).
+     */
+    class benchmark_t {
+    public:
+        using batch_t = std::function<void(std::uint64_t)> ;
+        struct options_t {
+            std::int64_t warmup_ms = 100 ;
+            std::int64_t sample_ms = 10 ;
+            std::size_t samples = 20 ;
+            std::string filter ;
+            std::string json ;
+            std::string compare ;
+        };
+        struct result_t {
+            std::string name ;
+            std::uint64_t iterations = 0 ;  // per sample
+            std::vector<double> samples ;   // nanoseconds per iteration
+            double median = 0.0 ;
+            double mad = 0.0 ;
+            double mean = 0.0 ;
+            double low = 0.0 ;              // 95% confidence interval of the median
+            double high = 0.0 ;
+        };
+    private:
+        struct entry_t {
+            std::string name ;
+            batch_t batch ;
+        };
+        static auto registry() ->std::vector<entry_t>& ;
+    public:
+        // function is called once per iteration, the loop is compiled around it
+        template <typename F>
+        static auto add(const std::string &name, F function) ->bool {
+            registry().push_back(entry_t{name, [function](std::uint64_t iterations) mutable {
+                for (std::uint64_t i = 0 ; i < iterations ; ++i){
+                    function();
+                }
+            }});
+            return true ;
+        }
+        static auto measure(const std::string &name, const batch_t &batch, const options_t &options) ->result_t ;
+        static auto write(const std::vector<result_t> &results, const std::string &path) ->void ;
+        // Handles --filter text, --samples n, --sample-ms n, --warmup-ms n, --json file, --compare file
+        static auto run(int argc, char *argv[]) ->int ;
+    };
+}
+
+#define UTIL_BENCHMARK_CONCAT_(a,b) a##b
+#define UTIL_BENCHMARK_CONCAT(a,b) UTIL_BENCHMARK_CONCAT_(a,b)
+#define UTIL_BENCHMARK(name, ...) static auto UTIL_BENCHMARK_CONCAT(benchmark_,__LINE__) = util::benchmark_t::add(name, __VA_ARGS__)
+
+#endif /* benchmark_hpp */
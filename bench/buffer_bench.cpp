@@ -0,0 +1,39 @@
+//Copyright © 2023 Charles Kerr. All rights reserved.
+
+#include <cstdint>
+
+#include "benchmark.hpp"
+#include "buffer.hpp"
+
+namespace {
+    //=================================================================================
+    auto write_integers() ->void {
+        auto buffer = util::buffer_t(4096) ;
+        for (auto i = std::uint32_t(0) ; i < 512 ; ++i){
+            buffer.write(i);
+        }
+        util::do_not_optimize(buffer.raw());
+    }
+    //=================================================================================
+    auto read_integers() ->void {
+        static auto buffer = util::buffer_t(4096 + 1) ;
+        buffer.at(0);
+        auto total = std::uint64_t(0) ;
+        for (auto i = 0 ; i < 1024 ; ++i){
+            total += buffer.read<std::uint32_t>(true);
+        }
+        util::do_not_optimize(total);
+    }
+    //=================================================================================
+    auto write_expanding() ->void {
+        auto buffer = util::buffer_t(1) ;
+        for (auto i = std::uint64_t(0) ; i < 256 ; ++i){
+            buffer.write(i);
+        }
+        util::do_not_optimize(buffer.raw());
+    }
+}
+
+UTIL_BENCHMARK("buffer_t/write 512 uint32", write_integers);
+UTIL_BENCHMARK("buffer_t/read 1024 uint32 reversed", read_integers);
+UTIL_BENCHMARK("buffer_t/write 256 uint64 expanding", write_expanding);
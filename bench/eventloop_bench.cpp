@@ -0,0 +1,68 @@
+//Copyright © 2023 Charles Kerr. All rights reserved.
+
+// Timeout churn benchmark for eventloop_t: an idle timeout re-armed on every event,
+// the old one cancelled, we report the time per re-arm. Built as C++20, so that the
+// coroutine awaitables are compiled; with --check it instead tests them, for ctest.
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "eventloop.hpp"
+#include "timer.hpp"
+
+#if !defined(UTIL_EVENTLOOP_COROUTINES)
+#error "eventloop_bench needs C++20 coroutines"
+#endif
+
+namespace {
+    //=================================================================================
+    auto sleeper(std::vector<int> &order, int id, std::int64_t milliseconds) ->util::eventloop_t::task_t {
+        co_await util::sleep_for(milliseconds);
+        order.push_back(id);
+    }
+    //=================================================================================
+    auto waiter(const util::timer_t &timer, bool &expired) ->util::eventloop_t::task_t {
+        co_await util::deadline(timer);
+        expired = timer.expired();
+    }
+    //=================================================================================
+    // Sleeps resume in deadline order, a deadline resumes once its timer has expired
+    auto check() ->bool {
+        auto loop = util::eventloop_t() ;
+        auto order = std::vector<int>() ;
+        auto expired = false ;
+        auto timer = util::timer_t() ;
+        timer.time(15, false);
+        auto clock = util::timer_t() ;
+        clock.start();
+        sleeper(order, 3, 30);
+        sleeper(order, 1, 10);
+        sleeper(order, 2, 20);
+        waiter(timer, expired);
+        loop.run();
+        auto elapsed = clock.elapsed() ;
+        auto pass = (order == std::vector<int>{1, 2, 3}) && expired && (elapsed >= 30) && (loop.pending() == 0) ;
+        std::cout << (pass ? "pass" : "FAIL") << " coroutines, elapsed ms: " << elapsed << std::endl;
+        return pass ;
+    }
+}
+
+//=================================================================================
+int main(int argc, char *argv[]) {
+    if ((argc > 1) && (std::string(argv[1]) == "--check")){
+        return check() ? 0 : 1 ;
+    }
+    auto loop = util::eventloop_t() ;
+    constexpr auto count = 1000000 ;
+    auto idle = loop.after(60000, [](){});
+    auto start = util::timer_t::ticks() ;
+    for (auto i = 0 ; i < count ; ++i){
+        loop.cancel(idle);
+        idle = loop.after(60000, [](){});
+    }
+    auto elapsed = util::timer_t::ticks() - start ;
+    std::cout << "re-armed idle timeout ns: " << static_cast<double>(elapsed) / count << " pending: " << loop.pending() << std::endl;
+    return 0;
+}
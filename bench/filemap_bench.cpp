@@ -0,0 +1,47 @@
+//Copyright © 2023 Charles Kerr. All rights reserved.
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <numeric>
+#include <string>
+
+#include "benchmark.hpp"
+#include "filemap.hpp"
+
+namespace {
+    //=================================================================================
+    // A 4 MB file in the temp directory, made once and removed at exit
+    struct sample_file_t {
+        std::filesystem::path path ;
+        sample_file_t():path(std::filesystem::temp_directory_path() / "utility_filemap_bench.bin"){
+            auto output = std::ofstream(path.string(), std::ios::binary);
+            auto block = std::string(4096, 'x') ;
+            for (auto i = 0 ; i < 1024 ; ++i){
+                output.write(block.data(), static_cast<std::streamsize>(block.size()));
+            }
+        }
+        ~sample_file_t(){
+            auto ec = std::error_code() ;
+            std::filesystem::remove(path, ec);
+        }
+    };
+    auto sample_file() ->const std::filesystem::path& {
+        static sample_file_t file ;
+        return file.path ;
+    }
+    //=================================================================================
+    auto map_unmap() ->void {
+        auto map = util::filemap_t(sample_file()) ;
+        util::do_not_optimize(map.ptr);
+    }
+    //=================================================================================
+    auto map_scan() ->void {
+        auto map = util::filemap_t(sample_file()) ;
+        auto total = std::accumulate(map.ptr, map.ptr + map.length, std::uint64_t(0));
+        util::do_not_optimize(total);
+    }
+}
+
+UTIL_BENCHMARK("filemap_t/map and unmap 4MB", map_unmap);
+UTIL_BENCHMARK("filemap_t/map and sum 4MB", map_scan);
@@ -0,0 +1,63 @@
+//Copyright © 2023 Charles Kerr. All rights reserved.
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "benchmark.hpp"
+#include "intern.hpp"
+#include "strutil.hpp"
+
+namespace {
+    //=================================================================================
+    // A config like line of 8 tags, the same few thousand tags over and over
+    auto tag_line(std::uint32_t &value) ->std::string {
+        auto rvalue = std::string() ;
+        for (auto i = 0 ; i < 8 ; ++i){
+            value = value * 1103515245 + 12345 ;
+            rvalue += "tag." + std::to_string((value >> 16) % 3000) + (i < 7 ? "," : "") ;
+        }
+        return rvalue ;
+    }
+    auto tag_lines() ->const std::vector<std::string>& {
+        static const auto data = [](){
+            auto rvalue = std::vector<std::string>() ;
+            auto value = std::uint32_t(50) ;
+            for (auto i = 0 ; i < 1000 ; ++i){
+                rvalue.push_back(tag_line(value));
+            }
+            return rvalue ;
+        }();
+        return data ;
+    }
+    util::intern_t pool ;
+    util::shared_intern_t<> shared ;
+}
+
+UTIL_BENCHMARK("intern/parse copies 1000 lines", [](){
+    auto tags = std::vector<std::string>() ;
+    for (const auto &line : tag_lines()){
+        auto fields = strutil::parse(line, ",");
+        tags.insert(tags.end(), fields.begin(), fields.end());
+    }
+    util::do_not_optimize(tags);
+});
+UTIL_BENCHMARK("intern/intern_t 1000 lines", [](){
+    auto tags = std::vector<util::intern_t::id_t>() ;
+    for (const auto &line : tag_lines()){
+        for (auto field : strutil::tokens(line, ",")){
+            tags.push_back(pool.intern(field));
+        }
+    }
+    util::do_not_optimize(tags);
+});
+UTIL_BENCHMARK("intern/shared_intern_t 1000 lines", [](){
+    auto tags = std::vector<util::intern_t::id_t>() ;
+    for (const auto &line : tag_lines()){
+        for (auto field : strutil::tokens(line, ",")){
+            tags.push_back(shared.intern(field));
+        }
+    }
+    util::do_not_optimize(tags);
+});
@@ -0,0 +1,10 @@
+//Copyright © 2023 Charles Kerr. All rights reserved.
+
+// Runs every benchmark registered with UTIL_BENCHMARK in this program
+
+#include "benchmark.hpp"
+
+//=================================================================================
+int main(int argc, char *argv[]) {
+    return util::benchmark_t::run(argc, argv);
+}
@@ -0,0 +1,72 @@
+//Copyright © 2023 Charles Kerr. All rights reserved.
+
+// Contention benchmark for shared id generators: 1 to 64 threads each take ids
+// for a fixed time, we report the ids handed out per second.
+
+#include <cstdint>
+#include <atomic>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "benchmark.hpp"
+#include "numinc.hpp"
+#include "timer.hpp"
+
+namespace {
+    //=================================================================================
+    template <typename T>
+    struct locked_t {
+        std::mutex access ;
+        util::numinc_t<T> generator ;
+        auto next() ->T {
+            auto lock = std::lock_guard(access);
+            return generator.next();
+        }
+    };
+    //=================================================================================
+    template <typename G>
+    auto contend(int threads, std::int64_t milliseconds) ->double {
+        G generator ;
+        std::atomic<bool> go{false} ;
+        std::atomic<std::uint64_t> total{0} ;
+        auto workers = std::vector<std::thread>() ;
+        for (auto i = 0 ; i < threads ; ++i){
+            workers.emplace_back([&](){
+                while (!go.load()){
+                    std::this_thread::yield();
+                }
+                auto clock = util::timer_t() ;
+                clock.time(milliseconds, false);
+                auto count = std::uint64_t(0) ;
+                while (!clock.expired()){
+                    for (auto j = 0 ; j < 256 ; ++j){
+                        util::do_not_optimize(generator.next());
+                    }
+                    count += 256 ;
+                }
+                total += count ;
+            });
+        }
+        go.store(true);
+        for (auto &worker : workers){
+            worker.join();
+        }
+        return static_cast<double>(total.load()) / (static_cast<double>(milliseconds) / 1000.0) ;
+    }
+}
+
+//=================================================================================
+int main() {
+    std::cout << std::setw(8) << "threads" << std::setw(18) << "mutex numinc_t" << std::setw(18) << "atomic uint64" << std::setw(18) << "atomic uint32" << std::setw(18) << "numlease uint64" << "   (ids/s)\n" ;
+    for (auto threads = 1 ; threads <= 64 ; threads *= 2){
+        std::cout << std::setw(8) << threads << std::setprecision(4)
+        << std::setw(18) << contend<locked_t<std::uint64_t>>(threads, 300)
+        << std::setw(18) << contend<util::atomic_numinc_t<std::uint64_t>>(threads, 300)
+        << std::setw(18) << contend<util::atomic_numinc_t<std::uint32_t>>(threads, 300)
+        << std::setw(18) << contend<util::numlease_t<std::uint64_t>>(threads, 300) << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,20 @@
+//Copyright © 2023 Charles Kerr. All rights reserved.
+
+#include <cstdint>
+
+#include "benchmark.hpp"
+#include "random.hpp"
+
+namespace {
+    using random_static = effolkronium::random_static ;
+    using random_thread_local = effolkronium::random_thread_local ;
+    using random_local = effolkronium::random_local ;
+    random_local local_engine ;
+}
+
+UTIL_BENCHMARK("random/static int", [](){ util::do_not_optimize(random_static::get(0, 1000)); });
+UTIL_BENCHMARK("random/static double", [](){ util::do_not_optimize(random_static::get(0.0, 1.0)); });
+UTIL_BENCHMARK("random/static bool", [](){ util::do_not_optimize(random_static::get<bool>()); });
+UTIL_BENCHMARK("random/thread_local int", [](){ util::do_not_optimize(random_thread_local::get(0, 1000)); });
+UTIL_BENCHMARK("random/local int", [](){ util::do_not_optimize(local_engine.get(0, 1000)); });
+UTIL_BENCHMARK("random/local uint64", [](){ util::do_not_optimize(local_engine.get<std::uint64_t>()); });
@@ -0,0 +1,194 @@
+//Copyright © 2023 Charles Kerr. All rights reserved.
+
+#include <cstdint>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "benchmark.hpp"
+#include "strutil.hpp"
+
+namespace {
+    //=================================================================================
+    const auto padded = std::string("  \t  some config value = 42   \r\n") ;
+    const auto spaced = std::string("  a  log   line\twith \t lots    of   whitespace  runs  in   it ") ;
+    const auto mixed = std::string("Content-Type: Application/JSON; Charset=UTF-8") ;
+    const auto number = std::string("1234567") ;
+    const auto long_number = std::string("1234567890123456789") ;
+    const auto real = std::string("3.14159265358979") ;
+    const auto fields = std::string("alpha, beta ,gamma,  delta,epsilon , 12345, 0x1F, zeta,eta  ,theta") ;
+    // spaced repeated out to length, for checking simplify scales linearly
+    auto log_line(std::size_t length) ->std::string {
+        auto rvalue = std::string() ;
+        while (rvalue.size() < length){
+            rvalue += spaced ;
+        }
+        rvalue.resize(length);
+        return rvalue ;
+    }
+    // 1000 decimal fields of 1 to 10 digits
+    auto number_column() ->const std::string& {
+        static const auto data = [](){
+            auto rvalue = std::string() ;
+            auto value = std::uint32_t(12345) ;
+            for (auto i = 0 ; i < 1000 ; ++i){
+                value = value * 1103515245 + 12345 ;
+                rvalue += std::to_string(value >> (value % 31)) + "," ;
+            }
+            rvalue.pop_back();
+            return rvalue ;
+        }();
+        return data ;
+    }
+    auto column_values() ->std::vector<std::uint64_t> {
+        auto rvalue = std::vector<std::uint64_t>() ;
+        auto value = std::uint64_t(88172645463325252) ;
+        for (auto i = 0 ; i < 1000 ; ++i){
+            value ^= value << 13 ;
+            value ^= value >> 7 ;
+            value ^= value << 17 ;
+            rvalue.push_back(value >> (value % 64));
+        }
+        return rvalue ;
+    }
+    // 200 made up keywords of 5 to 12 letters
+    auto keywords() ->const std::vector<std::string>& {
+        static const auto data = [](){
+            auto rvalue = std::vector<std::string>() ;
+            auto value = std::uint32_t(4049) ;
+            for (auto i = 0 ; i < 200 ; ++i){
+                auto word = std::string() ;
+                for (auto length = 5 + i % 8 ; length > 0 ; --length){
+                    value = value * 1103515245 + 12345 ;
+                    word += static_cast<char>('a' + (value >> 16) % 26);
+                }
+                rvalue.push_back(word);
+            }
+            return rvalue ;
+        }();
+        return data ;
+    }
+    auto bytes() ->const std::string& {
+        static const auto data = std::string(256, 'A') ;
+        return data ;
+    }
+}
+
+UTIL_BENCHMARK("strutil/trim", [](){ util::do_not_optimize(strutil::trim(padded)); });
+UTIL_BENCHMARK("strutil/trim view", [](){ util::do_not_optimize(strutil::trim(std::string_view(padded))); });
+UTIL_BENCHMARK("strutil/simplify", [](){ util::do_not_optimize(strutil::simplify(spaced)); });
+UTIL_BENCHMARK("strutil/simplify 1K", [line = log_line(1024)](){ util::do_not_optimize(strutil::simplify(line)); });
+UTIL_BENCHMARK("strutil/simplify 16K", [line = log_line(16384)](){ util::do_not_optimize(strutil::simplify(line)); });
+UTIL_BENCHMARK("strutil/simplify 256K", [line = log_line(262144)](){ util::do_not_optimize(strutil::simplify(line)); });
+UTIL_BENCHMARK("strutil/simplify in place 16K", [line = log_line(16384)]() mutable {
+    auto working = line ;
+    strutil::simplify_in_place(working);
+    util::do_not_optimize(working);
+});
+UTIL_BENCHMARK("strutil/upper", [](){ util::do_not_optimize(strutil::upper(mixed)); });
+UTIL_BENCHMARK("strutil/lower", [](){ util::do_not_optimize(strutil::lower(mixed)); });
+UTIL_BENCHMARK("strutil/lower in place", [working = mixed]() mutable {
+    strutil::lower_in_place(working);
+    util::do_not_optimize(working);
+});
+UTIL_BENCHMARK("strutil/iequals", [](){ util::do_not_optimize(strutil::iequals(mixed, "content-type: application/json; charset=utf-8")); });
+UTIL_BENCHMARK("strutil/ihash", [](){ util::do_not_optimize(strutil::ihash(mixed)); });
+UTIL_BENCHMARK("strutil/parse 10 fields", [](){ util::do_not_optimize(strutil::parse(fields, ",")); });
+UTIL_BENCHMARK("strutil/tokens 10 fields", [](){
+    for (auto field : strutil::tokens(fields, ",")){
+        util::do_not_optimize(field);
+    }
+});
+UTIL_BENCHMARK("strutil/split", [](){ util::do_not_optimize(strutil::split(padded, "=")); });
+UTIL_BENCHMARK("strutil/ntos uint32 hex", [](){ util::do_not_optimize(strutil::ntos(std::uint32_t(0xDEADBEEF), strutil::radix_t::hex, true, 8)); });
+UTIL_BENCHMARK("strutil/ntos int64 max", [](){ util::do_not_optimize(strutil::ntos(std::numeric_limits<std::int64_t>::max())); });
+UTIL_BENCHMARK("strutil/ntos 1000 uint64 into buffer", [values = column_values(), text = std::vector<char>(21000)]() mutable {
+    util::do_not_optimize(strutil::ntos(text.data(), text.size(), values.data(), values.size()));
+    util::do_not_optimize(text);
+});
+UTIL_BENCHMARK("strutil/ntos 1000 uint64 as strings", [values = column_values()](){
+    for (auto value : values){
+        util::do_not_optimize(strutil::ntos(value));
+    }
+});
+UTIL_BENCHMARK("strutil/ntos double", [](){ util::do_not_optimize(strutil::ntos(3.14159265358979)); });
+UTIL_BENCHMARK("strutil/ntos double into buffer", [](){
+    char text[32] ;
+    util::do_not_optimize(strutil::ntos(text, sizeof(text), 3.14159265358979, strutil::floatformat_t::fixed, 6));
+    util::do_not_optimize(text);
+});
+UTIL_BENCHMARK("strutil/stringstream double", [](){
+    std::ostringstream output ;
+    output << std::setprecision(17) << 3.14159265358979 ;
+    util::do_not_optimize(output.str());
+});
+UTIL_BENCHMARK("strutil/parse_number double", [](){ util::do_not_optimize(strutil::parse_number<double>(real)); });
+UTIL_BENCHMARK("strutil/ston int", [](){ util::do_not_optimize(strutil::ston<int>("1234567")); });
+UTIL_BENCHMARK("strutil/parse_number int", [](){ util::do_not_optimize(strutil::parse_number<int>(number)); });
+UTIL_BENCHMARK("strutil/parse_number uint64 19 digits", [](){ util::do_not_optimize(strutil::parse_number<std::uint64_t>(long_number)); });
+UTIL_BENCHMARK("strutil/parse_column 1000 uint32", [values = std::vector<std::uint32_t>(1000)]() mutable {
+    util::do_not_optimize(strutil::parse_column(number_column(), ',', values.data(), values.size()));
+});
+UTIL_BENCHMARK("strutil/format", [](){ util::do_not_optimize(strutil::format("%s = %d (%08x)", "value", 42, 0xBEEF)); });
+UTIL_BENCHMARK("strutil/formatter_t stack", [](){
+    static constexpr auto line = strutil::formatter_t("{} = {} ({:08x})");
+    char text[64] ;
+    util::do_not_optimize(line.format_to(text, sizeof(text), "value", 42, 0xBEEF));
+    util::do_not_optimize(text);
+});
+UTIL_BENCHMARK("strutil/formatter_t string", [](){
+    static constexpr auto line = strutil::formatter_t("{} = {} ({:08x})");
+    util::do_not_optimize(line.format("value", 42, 0xBEEF));
+});
+UTIL_BENCHMARK("strutil/sysTimeToString", [](){ util::do_not_optimize(strutil::sysTimeToString(std::chrono::system_clock::now())); });
+UTIL_BENCHMARK("strutil/stringToSysTime", [](){ util::do_not_optimize(strutil::stringToSysTime("Thu Dec 30 14:13:28 2021")); });
+UTIL_BENCHMARK("strutil/find 64K", [text = log_line(65536) + "needle"](){ util::do_not_optimize(strutil::find(text, "needle")); });
+UTIL_BENCHMARK("strutil/string::find 64K", [text = log_line(65536) + "needle"](){ util::do_not_optimize(text.find("needle")); });
+UTIL_BENCHMARK("strutil/matcher_t 200 keywords 64K", [text = log_line(65536), keywords = strutil::matcher_t(keywords())](){
+    auto count = std::size_t(0) ;
+    keywords.scan(text, [&count](const strutil::matcher_t::match_t&){ ++count ; });
+    util::do_not_optimize(count);
+});
+UTIL_BENCHMARK("strutil/string::find 200 keywords 64K", [text = log_line(65536)](){
+    auto count = std::size_t(0) ;
+    for (const auto &keyword : keywords()){
+        for (auto loc = text.find(keyword) ; loc != std::string::npos ; loc = text.find(keyword, loc + 1)){
+            ++count ;
+        }
+    }
+    util::do_not_optimize(count);
+});
+UTIL_BENCHMARK("strutil/parse_timestamp", [](){ util::do_not_optimize(strutil::parse_timestamp("2021-12-30T14:13:28.123456789+01:00")); });
+UTIL_BENCHMARK("strutil/parse_timestamps 1000", [texts = std::vector<std::string_view>(1000, "2021-12-30T14:13:28.123Z"), times = std::vector<strutil::nanotime_t>(1000)]() mutable {
+    util::do_not_optimize(strutil::parse_timestamps(texts.data(), texts.size(), times.data()));
+    util::do_not_optimize(times);
+});
+UTIL_BENCHMARK("strutil/dump 64K bytes", [data = std::string(65536, 'x')](){
+    std::ostringstream output ;
+    strutil::dump(output, reinterpret_cast<const std::uint8_t*>(data.data()), data.size());
+    util::do_not_optimize(output);
+});
+UTIL_BENCHMARK("strutil/hex_encode 4K", [data = std::vector<std::uint8_t>(4096, 0xA5), text = std::vector<char>(8192)]() mutable {
+    util::do_not_optimize(strutil::hex_encode(data.data(), data.size(), text.data()));
+    util::do_not_optimize(text);
+});
+UTIL_BENCHMARK("strutil/hex_decode 4K", [text = std::string(8192, 'c'), data = std::vector<std::uint8_t>(4096)]() mutable {
+    util::do_not_optimize(strutil::hex_decode(text, data.data()));
+    util::do_not_optimize(data);
+});
+UTIL_BENCHMARK("strutil/base64_encode 4K", [data = std::vector<std::uint8_t>(4096, 0xA5), text = std::vector<char>(strutil::base64_size(4096))]() mutable {
+    util::do_not_optimize(strutil::base64_encode(data.data(), data.size(), text.data()));
+    util::do_not_optimize(text);
+});
+UTIL_BENCHMARK("strutil/base64_decode 4K", [text = std::string(5464, 'Q'), data = std::vector<std::uint8_t>(4098)]() mutable {
+    auto length = std::size_t(0) ;
+    util::do_not_optimize(strutil::base64_decode(text, data.data(), length));
+    util::do_not_optimize(data);
+});
+UTIL_BENCHMARK("strutil/dump 256 bytes", [](){
+    std::ostringstream output ;
+    strutil::dump(output, reinterpret_cast<const std::uint8_t*>(bytes().data()), bytes().size());
+    util::do_not_optimize(output);
+});
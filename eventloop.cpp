@@ -0,0 +1,231 @@
+//Copyright © 2023 Charles Kerr. All rights reserved.
+
+#include "eventloop.hpp"
+
+#if defined(__linux__)
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <errno.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+using namespace std::string_literals;
+
+namespace util {
+    namespace {
+        thread_local eventloop_t *this_loop = nullptr ;
+        //=================================================================================
+        auto later(const std::pair<std::int64_t,eventloop_t::id_t> &lhs, const std::pair<std::int64_t,eventloop_t::id_t> &rhs) ->bool {
+            return lhs > rhs ;
+        }
+        //=================================================================================
+        auto drain(int fd) ->void {
+            std::uint64_t value ;
+            while (read(fd, &value, sizeof(value)) == sizeof(value)){
+            }
+        }
+    }
+
+    //=================================================================================
+    eventloop_t::eventloop_t():epoll_fd(-1),timer_fd(-1),wake_fd(-1),stopping(false),next_id(1),armed(0),cancelled(0){
+        epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK|TFD_CLOEXEC);
+        wake_fd = eventfd(0, EFD_NONBLOCK|EFD_CLOEXEC);
+        if ((epoll_fd == -1) || (timer_fd == -1) || (wake_fd == -1)){
+            auto error = std::string(std::strerror(errno)) ;
+            for (auto fd : {epoll_fd,timer_fd,wake_fd}){
+                if (fd != -1){
+                    close(fd);
+                }
+            }
+            throw std::runtime_error("Unable to create event loop: "s + error);
+        }
+        for (auto fd : {timer_fd,wake_fd}){
+            auto event = epoll_event{} ;
+            event.events = EPOLLIN ;
+            event.data.fd = fd ;
+            epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event);
+        }
+        if (this_loop == nullptr){
+            this_loop = this ;
+        }
+    }
+    //=================================================================================
+    eventloop_t::~eventloop_t() {
+        if (this_loop == this){
+            this_loop = nullptr ;
+        }
+        close(wake_fd);
+        close(timer_fd);
+        close(epoll_fd);
+    }
+    //=================================================================================
+    auto eventloop_t::current() ->eventloop_t* {
+        return this_loop ;
+    }
+
+    //=================================================================================
+    // Timeouts
+    //=================================================================================
+
+    //=================================================================================
+    auto eventloop_t::after(std::int64_t milliseconds, callback_t callback) ->id_t {
+        return at(timer_t::ticks() + milliseconds * 1000000, std::move(callback));
+    }
+    //=================================================================================
+    auto eventloop_t::at(std::int64_t tick, callback_t callback) ->id_t {
+        auto id = next_id++ ;
+        callbacks.emplace(id, std::move(callback));
+        deadlines.emplace_back(tick, id);
+        std::push_heap(deadlines.begin(), deadlines.end(), later);
+        arm();
+        return id ;
+    }
+    //=================================================================================
+    auto eventloop_t::cancel(id_t id) ->bool {
+        if (callbacks.erase(id) == 0){
+            return false ;
+        }
+        ++cancelled ;
+        if (cancelled * 2 > deadlines.size()){
+            compact();
+        }
+        arm();
+        return true ;
+    }
+    //=================================================================================
+    auto eventloop_t::pending() const ->std::size_t {
+        return callbacks.size();
+    }
+    //=================================================================================
+    // Point the timerfd at the earliest live deadline
+    auto eventloop_t::arm() ->void {
+        while (!deadlines.empty() && (callbacks.find(deadlines.front().second) == callbacks.end())){
+            std::pop_heap(deadlines.begin(), deadlines.end(), later);
+            deadlines.pop_back();
+            --cancelled ;
+        }
+        auto tick = deadlines.empty() ? std::int64_t(0) : std::max<std::int64_t>(deadlines.front().first, 1) ;
+        if (tick == armed){
+            return ;
+        }
+        auto spec = itimerspec{} ;
+        spec.it_value.tv_sec = static_cast<time_t>(tick / 1000000000) ;
+        spec.it_value.tv_nsec = static_cast<long>(tick % 1000000000) ;
+        timerfd_settime(timer_fd, TFD_TIMER_ABSTIME, &spec, nullptr);
+        armed = tick ;
+    }
+    //=================================================================================
+    auto eventloop_t::expire() ->void {
+        auto now = timer_t::ticks() ;
+        while (!deadlines.empty() && (deadlines.front().first <= now) && !stopping.load(std::memory_order_relaxed)){
+            auto id = deadlines.front().second ;
+            std::pop_heap(deadlines.begin(), deadlines.end(), later);
+            deadlines.pop_back();
+            auto iter = callbacks.find(id) ;
+            if (iter == callbacks.end()){
+                --cancelled ;
+                continue ;
+            }
+            auto callback = std::move(iter->second) ;
+            callbacks.erase(iter);
+            if (callback){
+                callback();
+            }
+        }
+        armed = 0 ;
+        arm();
+    }
+    //=================================================================================
+    // Drop every cancelled entry, so timeouts that keep being replaced (idle timeouts)
+    // do not grow the heap without bound
+    auto eventloop_t::compact() ->void {
+        deadlines.erase(std::remove_if(deadlines.begin(), deadlines.end(), [this](const std::pair<std::int64_t,id_t> &entry){
+            return callbacks.find(entry.second) == callbacks.end() ;
+        }), deadlines.end());
+        std::make_heap(deadlines.begin(), deadlines.end(), later);
+        cancelled = 0 ;
+    }
+
+    //=================================================================================
+    // File descriptors
+    //=================================================================================
+
+    //=================================================================================
+    auto eventloop_t::watch(int fd, std::uint32_t events, watcher_t watcher) ->void {
+        auto event = epoll_event{} ;
+        event.events = events ;
+        event.data.fd = fd ;
+        auto operation = (watchers.find(fd) == watchers.end()) ? EPOLL_CTL_ADD : EPOLL_CTL_MOD ;
+        if (epoll_ctl(epoll_fd, operation, fd, &event) == -1){
+            throw std::runtime_error("Unable to watch descriptor "s + std::to_string(fd) + ": "s + std::string(std::strerror(errno)));
+        }
+        watchers[fd] = std::move(watcher);
+    }
+    //=================================================================================
+    auto eventloop_t::unwatch(int fd) ->void {
+        if (watchers.erase(fd) != 0){
+            epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+        }
+    }
+
+    //=================================================================================
+    // Running
+    //=================================================================================
+
+    //=================================================================================
+    auto eventloop_t::run() ->void {
+        auto previous = this_loop ;
+        this_loop = this ;
+        // A stop() from before the loop started still stops it, the flag is only
+        // cleared once run() returns
+        std::array<epoll_event,64> events ;
+        expire();
+        while (!stopping.load() && (!callbacks.empty() || !watchers.empty())){
+            auto count = epoll_wait(epoll_fd, events.data(), static_cast<int>(events.size()), -1);
+            if (count == -1){
+                if (errno == EINTR){
+                    continue ;
+                }
+                this_loop = previous ;
+                stopping.store(false);
+                throw std::runtime_error("Event loop wait failed: "s + std::string(std::strerror(errno)));
+            }
+            for (auto i = 0 ; i < count ; ++i){
+                auto fd = events[i].data.fd ;
+                if (fd == timer_fd){
+                    drain(timer_fd);
+                    expire();
+                }
+                else if (fd == wake_fd){
+                    drain(wake_fd);
+                }
+                else {
+                    auto iter = watchers.find(fd) ;
+                    if (iter != watchers.end()){
+                        // Copy, the watcher may unwatch itself
+                        auto watcher = iter->second ;
+                        watcher(events[i].events);
+                    }
+                }
+            }
+        }
+        this_loop = previous ;
+        stopping.store(false);
+    }
+    //=================================================================================
+    auto eventloop_t::stop() ->void {
+        stopping.store(true);
+        std::uint64_t value = 1 ;
+        [[maybe_unused]] auto status = write(wake_fd, &value, sizeof(value));
+    }
+}
+
+#endif /* __linux__ */
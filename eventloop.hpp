@@ -0,0 +1,127 @@
+//Copyright © 2023 Charles Kerr. All rights reserved.
+
+#ifndef eventloop_hpp
+#define eventloop_hpp
+
+#if defined(__linux__)
+
+#include <cstdint>
+#include <atomic>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#include <coroutine>
+#include <exception>
+#include <stdexcept>
+#define UTIL_EVENTLOOP_COROUTINES 1
+#endif
+
+#include "timer.hpp"
+
+namespace util {
+    //=================================================================================
+    /* Single threaded event loop (Linux, epoll plus one timerfd).
+     Timeouts live in a heap keyed on their deadline, so a waiting timeout costs only its
+     entry, not a thread. Deadlines are timer_t::ticks() values (the monotonic clock).
+     With C++20, coroutines (returning eventloop_t::task_t) on the loop's thread can
+     co_await sleep_for(ms) and co_await deadline(timer). Without it, use after()/at().
+     A coroutine still suspended when its loop is destroyed is never resumed, and its
+     frame (with whatever it holds) is leaked: let them finish (run() until it returns)
+     before the loop goes.
+     Everything but stop() must be called from the thread running the loop (or before it runs).
+     */
+    class eventloop_t {
+    public:
+        using id_t = std::uint64_t ;
+        using callback_t = std::function<void()> ;
+        using watcher_t = std::function<void(std::uint32_t)> ;
+    private:
+        int epoll_fd ;
+        int timer_fd ;
+        int wake_fd ;
+        std::atomic<bool> stopping ;
+        id_t next_id ;
+        std::int64_t armed ;    // deadline the timerfd is set for, 0 when disarmed
+        // Min heap of (deadline,id); cancelled ids are dropped when they reach the top,
+        // or all at once when they come to be half the heap
+        std::vector<std::pair<std::int64_t,id_t>> deadlines ;
+        std::size_t cancelled ;     // entries in deadlines with no callback
+        std::unordered_map<id_t,callback_t> callbacks ;
+        std::unordered_map<int,watcher_t> watchers ;
+
+        auto arm() ->void ;
+        auto expire() ->void ;
+        auto compact() ->void ;
+    public:
+        eventloop_t() ;
+        ~eventloop_t() ;
+        eventloop_t(const eventloop_t&) = delete ;
+        auto operator=(const eventloop_t&) ->eventloop_t& = delete ;
+
+        // The loop made (or running) on this thread, nullptr if none
+        static auto current() ->eventloop_t* ;
+
+        auto after(std::int64_t milliseconds, callback_t callback) ->id_t ;
+        auto at(std::int64_t tick, callback_t callback) ->id_t ;
+        [[maybe_unused]] auto cancel(id_t id) ->bool ;
+        auto pending() const ->std::size_t ;
+
+        // events are EPOLLIN/EPOLLOUT..., the watcher gets what happened
+        auto watch(int fd, std::uint32_t events, watcher_t watcher) ->void ;
+        auto unwatch(int fd) ->void ;
+
+        // Runs until stop(), or until there is nothing left to wait for
+        auto run() ->void ;
+        // Safe from any thread
+        auto stop() ->void ;
+
+#if defined(UTIL_EVENTLOOP_COROUTINES)
+        //=================================================================================
+        // Fire and forget coroutine, it runs until its first suspension when called
+        struct task_t {
+            struct promise_type {
+                auto get_return_object() noexcept ->task_t { return task_t{}; }
+                auto initial_suspend() noexcept ->std::suspend_never { return {}; }
+                auto final_suspend() noexcept ->std::suspend_never { return {}; }
+                auto return_void() noexcept ->void {}
+                auto unhandled_exception() noexcept ->void { std::terminate(); }
+            };
+        };
+        //=================================================================================
+        class awaitable_t {
+            eventloop_t *loop ;
+            std::int64_t tick ;
+        public:
+            awaitable_t(eventloop_t *loop, std::int64_t tick):loop(loop),tick(tick){
+                if (loop == nullptr){
+                    throw std::runtime_error("No event loop is running on this thread");
+                }
+            }
+            auto await_ready() const noexcept ->bool { return tick <= timer_t::ticks(); }
+            auto await_suspend(std::coroutine_handle<> handle) ->void {
+                loop->at(tick, [handle](){ handle.resume(); });
+            }
+            auto await_resume() const noexcept ->void {}
+        };
+#endif
+    };
+
+#if defined(UTIL_EVENTLOOP_COROUTINES)
+    //=================================================================================
+    // Awaitables on the loop running on this thread
+    inline auto sleep_for(std::int64_t milliseconds) ->eventloop_t::awaitable_t {
+        return eventloop_t::awaitable_t(eventloop_t::current(), timer_t::ticks() + milliseconds * 1000000);
+    }
+    //=================================================================================
+    // Resumes once the timer has expired (timer_t::remaining() reaches 0)
+    inline auto deadline(const timer_t &timer) ->eventloop_t::awaitable_t {
+        return eventloop_t::awaitable_t(eventloop_t::current(), timer_t::ticks() + timer.remaining() * 1000000);
+    }
+#endif
+}
+
+#endif /* __linux__ */
+#endif /* eventloop_hpp */
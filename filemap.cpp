@@ -5,6 +5,7 @@
 #include <iostream>
 #include <stdexcept>
 #include <cstdio>
+#include <cstring>
 
 #if !defined(_WIN32)
 #include <sys/mman.h>
@@ -27,13 +28,13 @@ namespace util {
         }
     }
     //=================================================================================
-    filemap_t::filemap_t(const std::filesystem::path &filepath):filemap_t(){
+    filemap_t::filemap_t(const std::filesystem::path &filepath, bool writable):filemap_t(){
         if(!filepath.empty()){
-            map(filepath);
+            map(filepath,writable);
         }
     }
     //=================================================================================
-    auto filemap_t::map(const std::filesystem::path &filepath) ->std::uint8_t* {
+    auto filemap_t::map(const std::filesystem::path &filepath, bool writable) ->std::uint8_t* {
         if (ptr != nullptr){
             unmap();
         }
@@ -41,11 +42,11 @@ namespace util {
         path = filepath;
         length = std::filesystem::file_size(filepath);
 #if !defined(_WIN32)
-        auto fd  = open(filepath.string().c_str(), O_RDONLY);
+        auto fd  = open(filepath.string().c_str(), writable ? O_RDWR : O_RDONLY);
         if (fd == -1){
             throw std::runtime_error("Unable to open: "s + filepath.string());
         }
-        auto temp = mmap(0, length, PROT_READ, MAP_FILE|MAP_SHARED, fd, 0);
+        auto temp = mmap(0, length, writable ? (PROT_READ|PROT_WRITE) : PROT_READ, MAP_FILE|MAP_SHARED, fd, 0);
         if (temp == MAP_FAILED){
             close(fd) ;
             
@@ -57,7 +58,7 @@ namespace util {
 #else
         HANDLE hFile = ::CreateFileA(
                                      filepath.string().c_str(),
-                                     GENERIC_READ,
+                                     writable ? (GENERIC_READ|GENERIC_WRITE) : GENERIC_READ,
                                      FILE_SHARE_READ,
                                      nullptr,
                                      OPEN_EXISTING,
@@ -73,14 +74,14 @@ namespace util {
         //  the end iterator
         length = ::GetFileSize( hFile, nullptr );
         
-        HANDLE hMap = ::CreateFileMapping( hFile, nullptr, PAGE_READONLY, 0, 0, nullptr );
+        HANDLE hMap = ::CreateFileMapping( hFile, nullptr, writable ? PAGE_READWRITE : PAGE_READONLY, 0, 0, nullptr );
         
         if( hMap == nullptr ){
             ::CloseHandle( hFile );
             throw std::runtime_error("Error mapping file: "s + filepath.string());
         }
         
-        ptr = reinterpret_cast<std::uint8_t*>(::MapViewOfFile( hMap, FILE_MAP_READ, 0, 0, 0 ));
+        ptr = reinterpret_cast<std::uint8_t*>(::MapViewOfFile( hMap, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, 0 ));
         
         // We hold both the file handle and the memory pointer.
         // We can close the hMap handle now because Windows holds internally
@@ -120,4 +121,25 @@ namespace util {
         return status ;
     }
     
+    //=================================================================================
+    auto filemap_t::sync(std::size_t offset, std::size_t amount) ->void {
+        if ((ptr == nullptr) || (offset >= length)){
+            return ;
+        }
+        if ((amount == 0) || (offset + amount > length)){
+            amount = length - offset ;
+        }
+#if !defined(_WIN32)
+        // msync wants a page aligned start
+        auto page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+        auto start = offset - (offset % page) ;
+        if (msync(reinterpret_cast<void*>(ptr + start), amount + (offset - start), MS_SYNC) == -1){
+            throw std::runtime_error("Unable to sync: "s + std::string(std::strerror(errno))+". File: "s + path.string());
+        }
+#else
+        if (!::FlushViewOfFile(reinterpret_cast<void*>(ptr + offset), amount)){
+            throw std::runtime_error("Unable to sync: "s + path.string());
+        }
+#endif
+    }
 }
@@ -14,9 +14,12 @@ namespace util {
     public:
         filemap_t():ptr(nullptr),length(0){}
         ~filemap_t() ;
-        filemap_t(const std::filesystem::path &filepath);
-        [[maybe_unused]] auto map(const std::filesystem::path &filepath) ->std::uint8_t* ;
+        filemap_t(const std::filesystem::path &filepath, bool writable=false);
+        // A writable map is shared, changes go to the file
+        [[maybe_unused]] auto map(const std::filesystem::path &filepath, bool writable=false) ->std::uint8_t* ;
         [[maybe_unused]] auto unmap(bool nothrow=false)->bool ;
+        // Flush changes in [offset,offset+amount) to disk (amount 0 is to the end)
+        auto sync(std::size_t offset=0, std::size_t amount=0) ->void ;
         std::uint8_t *ptr ;
         std::size_t length ;
     };
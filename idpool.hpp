@@ -0,0 +1,193 @@
+//Copyright © 2023 Charles Kerr. All rights reserved.
+
+#ifndef idpool_hpp
+#define idpool_hpp
+
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace util {
+    //=================================================================================
+    // Index of the lowest set bit (value must not be 0)
+    inline auto lowest_bit(std::uint64_t value) ->unsigned {
+#if defined(_MSC_VER)
+        unsigned long index ;
+        _BitScanForward64(&index, value);
+        return static_cast<unsigned>(index);
+#else
+        return static_cast<unsigned>(__builtin_ctzll(value));
+#endif
+    }
+
+    //=================================================================================
+    /* Recycling id allocator. Like numinc_t, values run from initial+1 up to (not including)
+     the limit, but released values are handed out again, always the lowest free one first.
+     Free values are tracked in a hierarchical bitmap: a bit per value, and above that a bit
+     per word saying it has a free bit, so finding the lowest free value is one tzcnt per
+     level (log64 of the range). The bitmap only grows as far as the highest value handed
+     out, about 1 bit per id.
+     */
+    template <typename T>
+    class idpool_t {
+        static_assert(std::is_integral_v<T>,
+                      "idpool_t requires integral types");
+        T initial ;
+        T limit ;
+        std::uint64_t high ;    // values [0,high) have been handed out at some point
+        std::uint64_t in_use ;
+        // levels[0] has a bit per value (1 is free), levels[n+1] a bit per word of levels[n]
+        std::vector<std::vector<std::uint64_t>> levels ;
+
+        auto capacity() const ->std::uint64_t {
+            return static_cast<std::uint64_t>(limit) - static_cast<std::uint64_t>(initial) - 1 ;
+        }
+        auto grow(std::uint64_t index) ->void {
+            for (auto &level : levels){
+                index >>= 6 ;
+                if (level.size() <= index){
+                    level.resize(index + 1, 0);
+                }
+            }
+        }
+        auto mark_free(std::uint64_t index) ->void {
+            for (auto &level : levels){
+                auto &word = level[index >> 6] ;
+                auto had_free = word != 0 ;
+                word |= std::uint64_t(1) << (index & 63) ;
+                if (had_free){
+                    break ;
+                }
+                index >>= 6 ;
+            }
+        }
+        auto mark_used(std::uint64_t index) ->void {
+            for (auto &level : levels){
+                auto &word = level[index >> 6] ;
+                word &= ~(std::uint64_t(1) << (index & 63)) ;
+                if (word != 0){
+                    break ;
+                }
+                index >>= 6 ;
+            }
+        }
+        auto is_free(std::uint64_t index) const ->bool {
+            return (levels[0][index >> 6] & (std::uint64_t(1) << (index & 63))) != 0 ;
+        }
+        auto index_of(T value) const ->std::uint64_t {
+            if ((value <= initial) || (value >= limit)){
+                throw std::out_of_range(std::string("Value is outside the pool: ") + std::to_string(value));
+            }
+            return static_cast<std::uint64_t>(value) - static_cast<std::uint64_t>(initial) - 1 ;
+        }
+    public:
+        auto next() ->T {
+            auto index = std::uint64_t(0) ;
+            if (levels.back()[0] != 0){
+                for (auto level = levels.size() ; level-- > 0 ;){
+                    index = (index << 6) | lowest_bit(levels[level][index]) ;
+                }
+                mark_used(index);
+            }
+            else {
+                if (high == capacity()){
+                    throw std::runtime_error(std::string("Numeric limit has been reached: ") + std::to_string(limit));
+                }
+                index = high++ ;
+                grow(index);
+            }
+            in_use++ ;
+            return static_cast<T>(static_cast<std::uint64_t>(initial) + 1 + index) ;
+        }
+        // Returns false if the value was not in use
+        auto release(T value) ->bool {
+            auto index = index_of(value) ;
+            if ((index >= high) || is_free(index)){
+                return false ;
+            }
+            mark_free(index);
+            in_use-- ;
+            return true ;
+        }
+        // Takes a specific value, returns false if it was already in use
+        auto claim(T value) ->bool {
+            auto index = index_of(value) ;
+            if (index >= high){
+                // Everything skipped over becomes free
+                grow(index);
+                for (auto skipped = high ; skipped < index ; ++skipped){
+                    mark_free(skipped);
+                }
+                high = index + 1 ;
+            }
+            else if (is_free(index)){
+                mark_used(index);
+            }
+            else {
+                return false ;
+            }
+            in_use++ ;
+            return true ;
+        }
+        auto used(T value) const ->bool {
+            auto index = index_of(value) ;
+            return (index < high) && !is_free(index) ;
+        }
+        auto size() const ->std::uint64_t {
+            return in_use ;
+        }
+        idpool_t(T initial=0):idpool_t(initial,std::numeric_limits<T>::max()){}
+        idpool_t(T initial, T max_value):initial(initial),limit(max_value),high(0),in_use(0){
+            if (max_value <= initial){
+                throw std::runtime_error(std::string("Pool limit must be above the initial value: ") + std::to_string(max_value));
+            }
+            // Enough levels that the top one is a single word
+            auto words = capacity() / 64 + ((capacity() % 64 != 0) ? 1 : 0) ;
+            levels.emplace_back(1, 0);
+            while (words > 1){
+                words = words / 64 + ((words % 64 != 0) ? 1 : 0) ;
+                levels.emplace_back(1, 0);
+            }
+        }
+    };
+
+    //=================================================================================
+    // idpool_t behind a lock, to share between threads
+    template <typename T>
+    class shared_idpool_t {
+        mutable std::mutex access ;
+        idpool_t<T> pool ;
+    public:
+        auto next() ->T {
+            auto lock = std::lock_guard(access);
+            return pool.next();
+        }
+        auto release(T value) ->bool {
+            auto lock = std::lock_guard(access);
+            return pool.release(value);
+        }
+        auto claim(T value) ->bool {
+            auto lock = std::lock_guard(access);
+            return pool.claim(value);
+        }
+        auto used(T value) const ->bool {
+            auto lock = std::lock_guard(access);
+            return pool.used(value);
+        }
+        auto size() const ->std::uint64_t {
+            auto lock = std::lock_guard(access);
+            return pool.size();
+        }
+        shared_idpool_t(T initial=0):pool(initial){}
+        shared_idpool_t(T initial, T max_value):pool(initial,max_value){}
+    };
+}
+#endif /* idpool_hpp */
@@ -0,0 +1,302 @@
+//Copyright © 2023 Charles Kerr. All rights reserved.
+
+#ifndef intern_hpp
+#define intern_hpp
+
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace util {
+    //=================================================================================
+    /* String interning pool. Each distinct string is stored once, in an arena of 64K
+     blocks (longer strings get a block of their own), and given a dense id from 0 in the
+     order first seen. The views handed out stay valid for the life of the pool, even as
+     it grows, so two interned strings are equal exactly when their ids (or their views'
+     data pointers) are. Lookup is an open addressing table (linear probing, at most 3/4
+     full) of 8 byte slots: 32 bits of the hash beside the id, so only a slot whose hash
+     agrees is compared.
+     */
+    class intern_t {
+    public:
+        using id_t = std::uint32_t ;
+        static constexpr id_t none = std::numeric_limits<id_t>::max() ;
+    private:
+        static constexpr std::size_t block_size = 65536 ;
+        std::vector<std::unique_ptr<char[]>> blocks ;
+        char *cursor = nullptr ;
+        std::size_t left = 0 ;
+        std::size_t stored = 0 ;
+        std::vector<std::string_view> views ;
+        // (hash tag << 32) | (id + 1), 0 is an empty slot
+        std::vector<std::uint64_t> slots ;
+
+        auto store(std::string_view value) ->std::string_view {
+            if (value.empty()){
+                return std::string_view() ;
+            }
+            stored += value.size() ;
+            if (value.size() > left){
+                if (value.size() > block_size / 4){
+                    // Keep the current block for the short strings to come
+                    blocks.emplace_back(new char[value.size()]);
+                    std::memcpy(blocks.back().get(), value.data(), value.size());
+                    return std::string_view(blocks.back().get(), value.size()) ;
+                }
+                blocks.emplace_back(new char[block_size]);
+                cursor = blocks.back().get() ;
+                left = block_size ;
+            }
+            std::memcpy(cursor, value.data(), value.size());
+            auto rvalue = std::string_view(cursor, value.size()) ;
+            cursor += value.size() ;
+            left -= value.size() ;
+            return rvalue ;
+        }
+        auto rehash(std::size_t capacity) ->void {
+            slots.assign(capacity, 0);
+            auto mask = capacity - 1 ;
+            for (std::size_t id = 0 ; id < views.size() ; ++id){
+                auto hashed = hash(views[id]) ;
+                auto index = static_cast<std::size_t>(hashed) & mask ;
+                while (slots[index] != 0){
+                    index = (index + 1) & mask ;
+                }
+                slots[index] = ((hashed >> 32) << 32) | (id + 1) ;
+            }
+        }
+    public:
+        //=================================================================================
+        // The hash the pool uses, for intern(value, hashed) when it is already at hand
+        static auto hash(std::string_view value) ->std::uint64_t {
+            // Spread into the high bits too, which hold the tag (size_t may be 32 bits)
+            return static_cast<std::uint64_t>(std::hash<std::string_view>()(value)) * 0x9E3779B97F4A7C15ull ;
+        }
+        //=================================================================================
+        // The id of value, adding it if it is new
+        auto intern(std::string_view value) ->id_t {
+            return intern(value, hash(value));
+        }
+        auto intern(std::string_view value, std::uint64_t hashed) ->id_t {
+            if ((views.size() + 1) * 4 > slots.size() * 3){
+                rehash(slots.empty() ? 16 : slots.size() * 2);
+            }
+            auto mask = slots.size() - 1 ;
+            auto tag = hashed >> 32 ;
+            for (auto index = static_cast<std::size_t>(hashed) & mask ; ; index = (index + 1) & mask){
+                auto slot = slots[index] ;
+                if (slot == 0){
+                    if (views.size() >= none){
+                        throw std::runtime_error("Intern pool limit has been reached: " + std::to_string(views.size()));
+                    }
+                    auto id = static_cast<id_t>(views.size()) ;
+                    views.push_back(store(value));
+                    slots[index] = (tag << 32) | (static_cast<std::uint64_t>(id) + 1) ;
+                    return id ;
+                }
+                if ((slot >> 32) == tag){
+                    auto id = static_cast<id_t>((slot & 0xFFFFFFFF) - 1) ;
+                    if (views[id] == value){
+                        return id ;
+                    }
+                }
+            }
+        }
+        // The pool's copy of value, the same characters for every equal string
+        auto intern_view(std::string_view value) ->std::string_view {
+            return views[intern(value)] ;
+        }
+        //=================================================================================
+        // The id of value, none if it has not been interned
+        auto find(std::string_view value) const ->id_t {
+            if (slots.empty()){
+                return none ;
+            }
+            auto hashed = hash(value) ;
+            auto mask = slots.size() - 1 ;
+            auto tag = hashed >> 32 ;
+            for (auto index = static_cast<std::size_t>(hashed) & mask ; slots[index] != 0 ; index = (index + 1) & mask){
+                auto slot = slots[index] ;
+                if ((slot >> 32) == tag){
+                    auto id = static_cast<id_t>((slot & 0xFFFFFFFF) - 1) ;
+                    if (views[id] == value){
+                        return id ;
+                    }
+                }
+            }
+            return none ;
+        }
+        auto view(id_t id) const ->std::string_view {
+            if (id >= views.size()){
+                throw std::out_of_range("Symbol is not in the pool: " + std::to_string(id));
+            }
+            return views[id] ;
+        }
+        auto operator[](id_t id) const ->std::string_view {
+            return views[id] ;
+        }
+        auto size() const ->std::size_t {
+            return views.size() ;
+        }
+        // Characters held, each distinct string once
+        auto bytes() const ->std::size_t {
+            return stored ;
+        }
+        // Room in the table for count strings without rehashing
+        auto reserve(std::size_t count) ->void {
+            auto capacity = std::size_t(16) ;
+            while (capacity * 3 < count * 4){
+                capacity *= 2 ;
+            }
+            if (capacity > slots.size()){
+                rehash(capacity);
+            }
+            views.reserve(count);
+        }
+        // Every view handed out is invalid after this
+        auto clear() ->void {
+            blocks.clear();
+            cursor = nullptr ;
+            left = 0 ;
+            stored = 0 ;
+            views.clear();
+            slots.clear();
+        }
+    };
+
+    //=================================================================================
+    /* intern_t to share between threads. Strings go to one of Shards pools (by their
+     hash), each behind its own lock, so threads interning different strings rarely wait
+     on each other. Ids are still dense from 0 over the whole pool: each shard maps its
+     own ids to shared ones, and the views are published in a directory of segments (4096
+     views, doubling), so view() of an id takes no lock. A new string takes a shared lock
+     to be numbered and published, the count only moves on once its view is in place, so
+     every id under size() can be read.
+     */
+    template <std::size_t Shards = 16>
+    class shared_intern_t {
+        static_assert((Shards != 0) && ((Shards & (Shards - 1)) == 0),
+                      "shared_intern_t requires a power of two shard count");
+    public:
+        using id_t = intern_t::id_t ;
+        static constexpr id_t none = intern_t::none ;
+    private:
+        static constexpr std::size_t first_segment = 12 ;   // segment k holds 4096 << k views
+        static constexpr std::size_t segments = 33 - first_segment ;
+        struct shard_t {
+            std::mutex access ;
+            intern_t pool ;
+            std::vector<id_t> ids ;     // the shared id of each of the pool's ids
+        };
+        std::array<shard_t,Shards> shards ;
+        std::mutex publishing ;
+        std::atomic<std::uint64_t> count{0} ;   // ids [0,count) are published
+        std::array<std::atomic<std::string_view*>,segments> directory{} ;
+
+        static auto shard_of(std::uint64_t hashed) ->std::size_t {
+            // Bits neither the pools' slot index nor their tag leans on
+            return static_cast<std::size_t>(hashed >> 24) & (Shards - 1) ;
+        }
+        // Segment and position in it of an id
+        static auto locate(id_t id) ->std::pair<std::size_t,std::size_t> {
+            auto value = static_cast<std::uint64_t>(id) + (std::uint64_t(1) << first_segment) ;
+#if defined(_MSC_VER)
+            unsigned long high ;
+            _BitScanReverse64(&high, value);
+#else
+            auto high = 63 - __builtin_clzll(value) ;
+#endif
+            auto bit = static_cast<std::size_t>(high) ;
+            return {bit - first_segment, static_cast<std::size_t>(value - (std::uint64_t(1) << bit))} ;
+        }
+        // Numbers and publishes a new string, returns its id
+        auto publish(std::string_view value) ->id_t {
+            auto lock = std::lock_guard(publishing);
+            auto id = count.load(std::memory_order_relaxed) ;
+            if (id >= none){
+                throw std::runtime_error("Intern pool limit has been reached: " + std::to_string(id));
+            }
+            auto [segment, position] = locate(static_cast<id_t>(id)) ;
+            auto entries = directory[segment].load(std::memory_order_relaxed) ;
+            if (entries == nullptr){
+                entries = new std::string_view[std::size_t(1) << (segment + first_segment)] ;
+                directory[segment].store(entries, std::memory_order_release);
+            }
+            entries[position] = value ;
+            count.store(id + 1, std::memory_order_release);
+            return static_cast<id_t>(id) ;
+        }
+    public:
+        shared_intern_t() = default ;
+        ~shared_intern_t(){
+            for (auto &entries : directory){
+                delete[] entries.load() ;
+            }
+        }
+        shared_intern_t(const shared_intern_t&) = delete ;
+        auto operator=(const shared_intern_t&) ->shared_intern_t& = delete ;
+
+        //=================================================================================
+        auto intern(std::string_view value) ->id_t {
+            auto hashed = intern_t::hash(value) ;
+            auto &shard = shards[shard_of(hashed)] ;
+            auto lock = std::lock_guard(shard.access);
+            // Room for the new string's entry first, so once the pool has it its entry
+            // is there too: none until published, a failed publish() is tried again
+            if (shard.ids.size() == shard.ids.capacity()){
+                shard.ids.reserve(std::max<std::size_t>(shard.ids.size() * 2, 16));
+            }
+            auto local = shard.pool.intern(value, hashed) ;
+            if (local == shard.ids.size()){
+                shard.ids.push_back(none);
+            }
+            if (shard.ids[local] == none){
+                shard.ids[local] = publish(shard.pool[local]);
+            }
+            return shard.ids[local] ;
+        }
+        auto intern_view(std::string_view value) ->std::string_view {
+            return (*this)[intern(value)] ;
+        }
+        auto find(std::string_view value) ->id_t {
+            auto hashed = intern_t::hash(value) ;
+            auto &shard = shards[shard_of(hashed)] ;
+            auto lock = std::lock_guard(shard.access);
+            auto local = shard.pool.find(value) ;
+            // (an entry is none too while its string is unpublished)
+            return (local == none) ? none : shard.ids[local] ;
+        }
+        //=================================================================================
+        // These take no lock. view() accepts any id under size(); operator[] does not
+        // check, its id must have come from intern() (on any thread)
+        auto view(id_t id) const ->std::string_view {
+            if (id >= count.load(std::memory_order_acquire)){
+                throw std::out_of_range("Symbol is not in the pool: " + std::to_string(id));
+            }
+            return (*this)[id] ;
+        }
+        auto operator[](id_t id) const ->std::string_view {
+            auto [segment, position] = locate(id) ;
+            return directory[segment].load(std::memory_order_acquire)[position] ;
+        }
+        auto size() const ->std::size_t {
+            return static_cast<std::size_t>(count.load(std::memory_order_acquire)) ;
+        }
+    };
+}
+#endif /* intern_hpp */
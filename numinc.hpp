@@ -7,6 +7,15 @@
 #include <string>
 #include <limits>
 #include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "timer.hpp"
 
 namespace util{
     //=================================================================================
@@ -27,10 +36,203 @@ namespace util{
         }
         auto used(T value) ->numinc_t&{
             current_value=std::max(current_value,value);
+            return *this ;
         }
         numinc_t(T initial=0):current_value(initial),limit(std::numeric_limits<T>::max()){};
         numinc_t(T initial, T max_value):current_value(initial),limit(max_value){};
         
     };
+    
+    //=================================================================================
+    // Same semantics as numinc_t, safe to share between threads without a lock.
+    // 64 bit types use a fetch_add (the counter may run past the limit once it is
+    // reached, but no value at or past the limit is handed out); narrower types,
+    // where running past could wrap around, use a compare and swap.
+    template <typename T>
+    class atomic_numinc_t {
+        static_assert(std::is_integral_v<T>,
+                      "atomic_numinc_t requires integral types");
+        std::atomic<T> current_value ;
+        T limit ;
+        
+        [[noreturn]] auto exhausted() const ->void {
+            throw std::runtime_error(std::string("Numeric limit has been reached: ") + std::to_string(limit));
+        }
+    public:
+        auto next() ->T {
+            if constexpr (sizeof(T) >= sizeof(std::uint64_t)) {
+                auto value = current_value.fetch_add(1,std::memory_order_relaxed);
+                if (value >= limit - 1){
+                    exhausted();
+                }
+                return value + 1 ;
+            }
+            else {
+                auto value = current_value.load(std::memory_order_relaxed);
+                do {
+                    if (value >= limit - 1){
+                        exhausted();
+                    }
+                } while (!current_value.compare_exchange_weak(value, static_cast<T>(value + 1),std::memory_order_relaxed));
+                return static_cast<T>(value + 1) ;
+            }
+        }
+        // Claims up to count consecutive values at once, fewer if the limit is close.
+        // Returns the first and last value claimed.
+        auto reserve(T count) ->std::pair<T,T> {
+            if constexpr (sizeof(T) >= sizeof(std::uint64_t)) {
+                auto value = current_value.fetch_add(count,std::memory_order_relaxed);
+                if (value >= limit - 1){
+                    exhausted();
+                }
+                return std::make_pair(static_cast<T>(value + 1), static_cast<T>(value + std::min<T>(count, limit - 1 - value)));
+            }
+            else {
+                auto value = current_value.load(std::memory_order_relaxed);
+                auto last = value ;
+                do {
+                    if (value >= limit - 1){
+                        exhausted();
+                    }
+                    last = static_cast<T>(value + std::min<T>(count, static_cast<T>(limit - 1 - value)));
+                } while (!current_value.compare_exchange_weak(value, last,std::memory_order_relaxed));
+                return std::make_pair(static_cast<T>(value + 1), last);
+            }
+        }
+        // Atomic max, so a concurrent next() never hands out a value at or below it
+        auto used(T value) ->atomic_numinc_t&{
+            auto current = current_value.load(std::memory_order_relaxed);
+            while ((current < value) && !current_value.compare_exchange_weak(current, value,std::memory_order_relaxed)){
+            }
+            return *this ;
+        }
+        atomic_numinc_t(T initial=0):current_value(initial),limit(std::numeric_limits<T>::max()){};
+        atomic_numinc_t(T initial, T max_value):current_value(initial),limit(max_value){};
+        
+    };
+    
+    //=================================================================================
+    // Hands out the values of a shared atomic_numinc_t in blocks leased to each thread,
+    // so next() normally touches only thread local data. Values are unique and below the
+    // limit, but only increase within a thread. The block size adapts: a thread that
+    // empties its block quickly gets a bigger one next time, a slow one a smaller one.
+    // Unused values are given back when a thread ends (or calls release()) and are leased
+    // again before any new values.
+    template <typename T>
+    class numlease_t {
+        static_assert(std::is_integral_v<T>,
+                      "numlease_t requires integral types");
+        struct shared_t {
+            atomic_numinc_t<T> counter ;
+            T min_block ;
+            T max_block ;
+            std::mutex access ;
+            std::vector<std::pair<T,T>> returned ;
+            shared_t(T initial, T max_value, T min_block, T max_block):counter(initial,max_value),min_block(min_block),max_block(max_block){}
+            auto give_back(T first, T last) ->void {
+                auto lock = std::lock_guard(access);
+                returned.emplace_back(first,last);
+            }
+        };
+        //=================================================================================
+        // A thread's lease on one generator, it keeps the shared state alive
+        struct lease_t {
+            std::shared_ptr<shared_t> shared ;
+            T next ;
+            T last ;
+            T block ;
+            bool empty ;
+            std::int64_t leased_at ;
+            lease_t(const std::shared_ptr<shared_t> &shared):shared(shared),next(0),last(0),block(shared->min_block),empty(true),leased_at(0){}
+            lease_t(lease_t &&other) noexcept :shared(std::move(other.shared)),next(other.next),last(other.last),block(other.block),empty(other.empty),leased_at(other.leased_at){
+                other.empty = true ;
+            }
+            auto operator=(lease_t &&other) noexcept ->lease_t& {
+                std::swap(shared, other.shared);
+                std::swap(next, other.next);
+                std::swap(last, other.last);
+                std::swap(block, other.block);
+                std::swap(empty, other.empty);
+                std::swap(leased_at, other.leased_at);
+                return *this ;
+            }
+            ~lease_t(){
+                release();
+            }
+            auto release() ->void {
+                if (!empty && (shared != nullptr)){
+                    shared->give_back(next, last);
+                }
+                empty = true ;
+            }
+            auto refill() ->void {
+                // Aim for a block to last about a millisecond
+                auto now = timer_t::ticks() ;
+                if (leased_at != 0){
+                    auto took = now - leased_at ;
+                    if ((took < 1000000) && (block <= shared->max_block / 2)){
+                        block = static_cast<T>(block * 2) ;
+                    }
+                    else if ((took > 100000000) && (block >= shared->min_block * 2)){
+                        block = static_cast<T>(block / 2) ;
+                    }
+                }
+                leased_at = now ;
+                {
+                    auto lock = std::lock_guard(shared->access);
+                    if (!shared->returned.empty()){
+                        std::tie(next,last) = shared->returned.back();
+                        shared->returned.pop_back();
+                        empty = false ;
+                        return ;
+                    }
+                }
+                std::tie(next,last) = shared->counter.reserve(block);
+                empty = false ;
+            }
+        };
+        //=================================================================================
+        static auto leases() ->std::vector<lease_t>& {
+            thread_local std::vector<lease_t> instance ;
+            return instance ;
+        }
+        auto lease() ->lease_t& {
+            auto &local = leases() ;
+            for (auto &entry : local){
+                if (entry.shared == shared){
+                    return entry ;
+                }
+            }
+            // Drop leases of generators that no longer exist, nothing can use them
+            local.erase(std::remove_if(local.begin(), local.end(), [](const lease_t &entry){
+                return entry.shared.use_count() == 1 ;
+            }), local.end());
+            local.emplace_back(shared);
+            return local.back();
+        }
+        
+        std::shared_ptr<shared_t> shared ;
+    public:
+        auto next() ->T {
+            auto &local = lease() ;
+            if (local.empty){
+                local.refill();
+            }
+            auto value = local.next ;
+            if (local.next == local.last){
+                local.empty = true ;
+            }
+            else {
+                ++local.next ;
+            }
+            return value ;
+        }
+        // Give the calling thread's unused values back
+        auto release() ->void {
+            lease().release();
+        }
+        numlease_t(T initial=0, T max_value=std::numeric_limits<T>::max(), T min_block=16, T max_block=65536):shared(std::make_shared<shared_t>(initial,max_value,std::max<T>(min_block,1),std::max<T>(max_block,std::max<T>(min_block,1)))){};
+        
+    };
 }
 #endif /* numinc_hpp */
@@ -0,0 +1,233 @@
+//Copyright © 2023 Charles Kerr. All rights reserved.
+
+#include "profiler.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <mutex>
+#include <stdexcept>
+
+#if !defined(_WIN32)
+#include <errno.h>
+#include <signal.h>
+#include <sys/time.h>
+#include <time.h>
+#endif
+
+using namespace std::string_literals;
+
+namespace util {
+    namespace {
+        //=================================================================================
+        // Plain pointer, constant initialized, so reading it in the handler is safe
+        thread_local profiler_t::slot_t *local_slot = nullptr ;
+
+        std::atomic<profiler_t::slot_t*> slots{nullptr} ;
+        std::atomic<std::uint64_t> unattached{0} ;      // samples of threads with no slot
+        std::atomic<std::int64_t> sample_interval{0} ;  // microseconds, 0 when stopped
+        std::atomic<std::int64_t> last_interval{1000} ; // what report() estimates time with
+
+        std::mutex names_access ;
+        std::array<const char*,profiler_t::max_regions> names{"(outside)"} ;
+        std::size_t name_count = 1 ;
+
+#if defined(__linux__)
+        ::timer_t sample_timer ;
+#endif
+        //=================================================================================
+        // Hands the slot back when its thread ends, the counts stay in it
+        struct release_t {
+            ~release_t(){
+                if (local_slot != nullptr){
+                    local_slot->current.store(profiler_t::outside, std::memory_order_relaxed);
+                    local_slot->used.store(false, std::memory_order_release);
+                }
+            }
+        };
+
+#if !defined(_WIN32)
+        //=================================================================================
+        // Expirations that came while a signal was still pending are reported as overruns,
+        // they are charged to the same region so the time estimate stays right
+        auto profiler_signal(int, siginfo_t *info, void*) ->void {
+            auto count = std::uint64_t(1) ;
+#if defined(__linux__)
+            if ((info != nullptr) && (info->si_code == SI_TIMER) && (info->si_overrun > 0)){
+                count += static_cast<std::uint64_t>(info->si_overrun) ;
+            }
+#else
+            static_cast<void>(info);
+#endif
+            auto slot = local_slot ;
+            if (slot == nullptr){
+                unattached.fetch_add(count, std::memory_order_relaxed);
+                return ;
+            }
+            auto region = slot->current.load(std::memory_order_relaxed);
+            if (region >= profiler_t::max_regions){
+                region = profiler_t::outside ;
+            }
+            slot->samples[region].fetch_add(count, std::memory_order_relaxed);
+        }
+#endif
+    }
+
+    //=================================================================================
+    auto profiler_t::region(const char *name) ->std::uint16_t {
+        auto lock = std::lock_guard(names_access);
+        for (std::size_t i = 0 ; i < name_count ; ++i){
+            if (std::strcmp(names[i], name) == 0){
+                return static_cast<std::uint16_t>(i);
+            }
+        }
+        if (name_count == max_regions){
+            throw std::runtime_error("Profiler region limit has been reached: "s + std::to_string(max_regions));
+        }
+        names[name_count] = name ;
+        return static_cast<std::uint16_t>(name_count++);
+    }
+    //=================================================================================
+    auto profiler_t::slot() ->slot_t& {
+        if (local_slot != nullptr){
+            return *local_slot ;
+        }
+        // Reuse a slot a finished thread gave back, otherwise add one
+        auto found = slots.load(std::memory_order_acquire) ;
+        while (found != nullptr){
+            auto unused = false ;
+            if (found->used.compare_exchange_strong(unused, true)){
+                break ;
+            }
+            found = found->next ;
+        }
+        if (found == nullptr){
+            found = new slot_t() ;
+            found->used.store(true);
+            found->next = slots.load();
+            while (!slots.compare_exchange_weak(found->next, found)){
+            }
+        }
+        thread_local release_t release ;
+        local_slot = found ;
+        return *found ;
+    }
+
+    //=================================================================================
+    auto profiler_t::start(std::int64_t interval) ->void {
+#if defined(_WIN32)
+        throw std::runtime_error("Sampling profiler is not supported on this platform");
+#else
+        if (interval <= 0){
+            throw std::runtime_error("Sampling interval must be greater than zero: "s + std::to_string(interval));
+        }
+        if (running()){
+            stop();
+        }
+        struct sigaction action;
+        std::memset(&action, 0, sizeof(action));
+        action.sa_sigaction = profiler_signal ;
+        action.sa_flags = SA_RESTART | SA_SIGINFO ;
+        sigemptyset(&action.sa_mask);
+        if (sigaction(SIGPROF, &action, nullptr) == -1){
+            throw std::runtime_error("Unable to install SIGPROF handler: "s + std::string(std::strerror(errno)));
+        }
+#if defined(__linux__)
+        struct sigevent event;
+        std::memset(&event, 0, sizeof(event));
+        event.sigev_notify = SIGEV_SIGNAL ;
+        event.sigev_signo = SIGPROF ;
+        if (timer_create(CLOCK_PROCESS_CPUTIME_ID, &event, &sample_timer) == -1){
+            throw std::runtime_error("Unable to create sampling timer: "s + std::string(std::strerror(errno)));
+        }
+        struct itimerspec spec;
+        std::memset(&spec, 0, sizeof(spec));
+        spec.it_interval.tv_sec = static_cast<time_t>(interval / 1000000) ;
+        spec.it_interval.tv_nsec = static_cast<long>((interval % 1000000) * 1000) ;
+        spec.it_value = spec.it_interval ;
+        if (timer_settime(sample_timer, 0, &spec, nullptr) == -1){
+            timer_delete(sample_timer);
+            throw std::runtime_error("Unable to start sampling timer: "s + std::string(std::strerror(errno)));
+        }
+#else
+        struct itimerval spec;
+        std::memset(&spec, 0, sizeof(spec));
+        spec.it_interval.tv_sec = static_cast<time_t>(interval / 1000000) ;
+        spec.it_interval.tv_usec = static_cast<suseconds_t>(interval % 1000000) ;
+        spec.it_value = spec.it_interval ;
+        if (setitimer(ITIMER_PROF, &spec, nullptr) == -1){
+            throw std::runtime_error("Unable to start sampling timer: "s + std::string(std::strerror(errno)));
+        }
+#endif
+        sample_interval.store(interval);
+        last_interval.store(interval);
+#endif
+    }
+    //=================================================================================
+    // The handler stays installed, a late signal must not take the default action
+    auto profiler_t::stop() ->void {
+#if !defined(_WIN32)
+        if (!running()){
+            return ;
+        }
+#if defined(__linux__)
+        timer_delete(sample_timer);
+#else
+        struct itimerval spec;
+        std::memset(&spec, 0, sizeof(spec));
+        setitimer(ITIMER_PROF, &spec, nullptr);
+#endif
+        sample_interval.store(0);
+#endif
+    }
+    //=================================================================================
+    auto profiler_t::running() ->bool {
+        return sample_interval.load() != 0 ;
+    }
+
+    //=================================================================================
+    auto profiler_t::report() ->std::vector<result_t> {
+        auto totals = std::array<std::uint64_t,max_regions>{} ;
+        totals[outside] = unattached.load(std::memory_order_relaxed);
+        for (auto slot = slots.load(std::memory_order_acquire) ; slot != nullptr ; slot = slot->next){
+            for (std::size_t i = 0 ; i < max_regions ; ++i){
+                totals[i] += slot->samples[i].load(std::memory_order_relaxed);
+            }
+        }
+        auto interval = static_cast<double>(last_interval.load()) ;
+        auto rvalue = std::vector<result_t>() ;
+        auto lock = std::lock_guard(names_access);
+        for (std::size_t i = 0 ; i < name_count ; ++i){
+            if (totals[i] != 0){
+                rvalue.push_back(result_t{names[i], totals[i], static_cast<double>(totals[i]) * interval / 1000.0});
+            }
+        }
+        std::sort(rvalue.begin(), rvalue.end(), [](const result_t &lhs, const result_t &rhs){
+            return lhs.samples > rhs.samples ;
+        });
+        return rvalue ;
+    }
+    //=================================================================================
+    auto profiler_t::write(std::ostream &output) ->void {
+        auto results = report() ;
+        auto total = std::uint64_t(0) ;
+        for (const auto &result : results){
+            total += result.samples ;
+        }
+        output << std::left << std::setw(40) << "region" << std::right << std::setw(12) << "samples" << std::setw(10) << "%" << std::setw(14) << "est. ms" << "\n";
+        for (const auto &result : results){
+            output << std::left << std::setw(40) << result.name << std::right << std::setw(12) << result.samples
+            << std::setw(10) << std::fixed << std::setprecision(1) << (100.0 * static_cast<double>(result.samples) / static_cast<double>(total))
+            << std::setw(14) << result.milliseconds << "\n";
+        }
+    }
+    //=================================================================================
+    auto profiler_t::reset() ->void {
+        unattached.store(0);
+        for (auto slot = slots.load(std::memory_order_acquire) ; slot != nullptr ; slot = slot->next){
+            for (auto &count : slot->samples){
+                count.store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+}
@@ -0,0 +1,80 @@
+//Copyright © 2023 Charles Kerr. All rights reserved.
+
+#ifndef profiler_hpp
+#define profiler_hpp
+
+#include <cstdint>
+#include <array>
+#include <atomic>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace util {
+    //=================================================================================
+    /* Sampling profiler for always on use.
+     Code marks regions with profregion_t (or UTIL_PROFILE_REGION), which only stores a tag
+     in the thread's slot. A SIGPROF timer on process cpu time samples whichever thread is
+     running, and the handler adds one to that thread's count for its current region.
+     The handler is async-signal-safe: no locks, no allocation, only relaxed atomics.
+     Sampling needs POSIX (timer_create on Linux, setitimer elsewhere); on Windows the
+     markers work but start() throws.
+     */
+    class profiler_t {
+    public:
+        static constexpr std::size_t max_regions = 256 ;
+        // Region 0 collects samples outside any marked region
+        static constexpr std::uint16_t outside = 0 ;
+
+        struct slot_t {
+            std::atomic<std::uint16_t> current{outside} ;
+            std::atomic<bool> used{false} ;
+            std::array<std::atomic<std::uint64_t>,max_regions> samples{} ;
+            slot_t *next = nullptr ;
+        };
+        struct result_t {
+            std::string name ;
+            std::uint64_t samples ;
+            double milliseconds ;   // samples times the sampling interval
+        };
+
+        // Registers a region name (kept by pointer, so use a literal), same name gives the same tag
+        static auto region(const char *name) ->std::uint16_t ;
+        // The calling thread's slot, made on first use
+        static auto slot() ->slot_t& ;
+
+        // Sample every interval microseconds of process cpu time
+        static auto start(std::int64_t interval = 1000) ->void ;
+        static auto stop() ->void ;
+        static auto running() ->bool ;
+
+        // Totals over all threads, busiest region first
+        static auto report() ->std::vector<result_t> ;
+        static auto write(std::ostream &output) ->void ;
+        static auto reset() ->void ;
+    };
+
+    //=================================================================================
+    // Sets the thread's region for its lifetime, restoring the enclosing one after
+    class profregion_t {
+        profiler_t::slot_t &slot ;
+        std::uint16_t previous ;
+    public:
+        explicit profregion_t(std::uint16_t region):slot(profiler_t::slot()),previous(slot.current.load(std::memory_order_relaxed)){
+            slot.current.store(region, std::memory_order_relaxed);
+        }
+        ~profregion_t(){
+            slot.current.store(previous, std::memory_order_relaxed);
+        }
+        profregion_t(const profregion_t&) = delete ;
+        auto operator=(const profregion_t&) ->profregion_t& = delete ;
+    };
+}
+
+#define UTIL_PROFILE_CONCAT_(a,b) a##b
+#define UTIL_PROFILE_CONCAT(a,b) UTIL_PROFILE_CONCAT_(a,b)
+#define UTIL_PROFILE_REGION(name) \
+    static const auto UTIL_PROFILE_CONCAT(profile_tag_,__LINE__) = util::profiler_t::region(name); \
+    util::profregion_t UTIL_PROFILE_CONCAT(profile_region_,__LINE__)(UTIL_PROFILE_CONCAT(profile_tag_,__LINE__))
+
+#endif /* profiler_hpp */
@@ -0,0 +1,125 @@
+//Copyright © 2023 Charles Kerr. All rights reserved.
+
+#include "ratelimit.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+using namespace std::string_literals;
+
+namespace util {
+    namespace {
+        //=================================================================================
+        auto nanoseconds_per(double rate) ->std::int64_t {
+            if (!(rate > 0.0)){
+                throw std::runtime_error("Rate must be greater than zero: "s + std::to_string(rate));
+            }
+            return std::max<std::int64_t>(1, std::llround(1000000000.0 / rate));
+        }
+    }
+
+    //=================================================================================
+    // gcra_t
+    //=================================================================================
+
+    //=================================================================================
+    gcra_t::gcra_t(double rate, std::uint32_t burst):arrival(0),interval(nanoseconds_per(rate)),tolerance(0){
+        if (burst == 0){
+            throw std::runtime_error("Burst must be at least one");
+        }
+        tolerance = interval * burst ;
+    }
+    //=================================================================================
+    auto gcra_t::try_acquire(std::uint32_t count) ->bool {
+        auto now = timer_t::ticks() ;
+        auto cost = interval * count ;
+        auto current = arrival.load(std::memory_order_relaxed);
+        while (true){
+            auto next = std::max(current, now) + cost ;
+            if (next - now > tolerance){
+                return false ;
+            }
+            if (arrival.compare_exchange_weak(current, next, std::memory_order_acq_rel, std::memory_order_relaxed)){
+                return true ;
+            }
+        }
+    }
+    //=================================================================================
+    auto gcra_t::deadline(std::uint32_t count) const ->std::int64_t {
+        auto now = timer_t::ticks() ;
+        auto cost = interval * count ;
+        if (cost > tolerance){
+            return std::numeric_limits<std::int64_t>::max() ;
+        }
+        return std::max(std::max(arrival.load(std::memory_order_acquire), now) + cost - tolerance, now);
+    }
+
+    //=================================================================================
+    // tokenbucket_t
+    //=================================================================================
+
+    //=================================================================================
+    tokenbucket_t::tokenbucket_t(double rate, std::uint32_t burst):state(0),origin(timer_t::ticks()),interval(nanoseconds_per(rate)),capacity(burst){
+        if ((burst == 0) || (burst > max_burst)){
+            throw std::runtime_error("Burst must be between 1 and "s + std::to_string(max_burst) + ": "s + std::to_string(burst));
+        }
+        state.store(capacity);
+    }
+    //=================================================================================
+    // Credit the tokens earned since the last refill. Time is kept in whole intervals,
+    // so it only moves on by what the tokens earned cost, and the part of an interval
+    // not yet earned carries over to the next refill. The time is 48 bits that wrap,
+    // the intervals elapsed are their difference modulo 2^48. now is always read after
+    // word was loaded, so it is never behind the time in it.
+    auto tokenbucket_t::refill(std::uint64_t word, std::int64_t now) const ->std::uint64_t {
+        auto last = word >> token_bits ;
+        auto tokens = word & token_mask ;
+        auto current = static_cast<std::uint64_t>((now - origin) / interval) & time_mask ;
+        auto earned = (current - last) & time_mask ;
+        if (earned == 0){
+            return word ;
+        }
+        // A full bucket earns nothing more, the time while it was full is not owed
+        tokens = std::min<std::uint64_t>(tokens + earned, capacity) ;
+        return (current << token_bits) | tokens ;
+    }
+    //=================================================================================
+    auto tokenbucket_t::try_acquire(std::uint32_t count) ->bool {
+        auto current = state.load(std::memory_order_acquire);
+        auto now = timer_t::ticks() ;
+        while (true){
+            auto word = refill(current, now);
+            if ((word & token_mask) < count){
+                return false ;
+            }
+            if (state.compare_exchange_weak(current, word - count, std::memory_order_acq_rel, std::memory_order_acquire)){
+                return true ;
+            }
+            // Another thread moved the time on, read the clock after it
+            now = timer_t::ticks() ;
+        }
+    }
+    //=================================================================================
+    auto tokenbucket_t::deadline(std::uint32_t count) const ->std::int64_t {
+        if (count > capacity){
+            return std::numeric_limits<std::int64_t>::max() ;
+        }
+        auto word = state.load(std::memory_order_acquire);
+        auto now = timer_t::ticks() ;
+        auto tokens = refill(word, now) & token_mask ;
+        if (tokens >= count){
+            return now ;
+        }
+        // The refill moved the time to the current interval
+        auto current = (now - origin) / interval ;
+        return origin + (current + static_cast<std::int64_t>(count - tokens)) * interval ;
+    }
+    //=================================================================================
+    auto tokenbucket_t::available() const ->std::uint32_t {
+        auto word = state.load(std::memory_order_acquire);
+        return static_cast<std::uint32_t>(refill(word, timer_t::ticks()) & token_mask);
+    }
+}
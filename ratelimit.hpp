@@ -0,0 +1,60 @@
+//Copyright © 2023 Charles Kerr. All rights reserved.
+
+#ifndef ratelimit_hpp
+#define ratelimit_hpp
+
+#include <cstdint>
+#include <atomic>
+
+#include "timer.hpp"
+
+namespace util {
+    //=================================================================================
+    /* Lock free rate limiters, safe to share between threads.
+     Times are timer_t::ticks() (monotonic nanoseconds). Neither blocks: when a request
+     is refused, deadline() says when it would be granted, so the caller can sleep or
+     schedule (a timerwheel_t for instance) until then.
+     */
+
+    //=================================================================================
+    // Generic cell rate algorithm. The whole state is the theoretical arrival time.
+    class gcra_t {
+        std::atomic<std::int64_t> arrival ;
+        std::int64_t interval ;     // nanoseconds per token
+        std::int64_t tolerance ;    // how far arrival may run ahead of now (burst*interval)
+    public:
+        gcra_t(double rate, std::uint32_t burst = 1) ;
+
+        [[maybe_unused]] auto try_acquire(std::uint32_t count = 1) ->bool ;
+        // The tick at which count tokens would be granted (now if they would be now).
+        // A count larger than the burst is never granted, and gives the largest tick.
+        auto deadline(std::uint32_t count = 1) const ->std::int64_t ;
+    };
+
+    //=================================================================================
+    // Token bucket. Tokens and the last refill time are packed into one word:
+    // 48 bits of whole intervals (nanoseconds per token) since construction and 16 bits
+    // of tokens. The intervals wrap (every 78 hours at a billion tokens a second), only
+    // their difference is used, so the bucket keeps limiting across the wrap. A bucket
+    // left untouched for a whole multiple of 2^48 intervals may come back short of full.
+    class tokenbucket_t {
+        static constexpr int token_bits = 16 ;
+        static constexpr std::uint64_t token_mask = (std::uint64_t(1) << token_bits) - 1 ;
+        static constexpr std::uint64_t time_mask = (std::uint64_t(1) << (64 - token_bits)) - 1 ;
+        std::atomic<std::uint64_t> state ;
+        std::int64_t origin ;       // tick of construction
+        std::int64_t interval ;     // nanoseconds per token
+        std::uint32_t capacity ;
+
+        auto refill(std::uint64_t word, std::int64_t now) const ->std::uint64_t ;
+    public:
+        static constexpr std::uint32_t max_burst = static_cast<std::uint32_t>(token_mask) ;
+        // The bucket starts full, burst is its capacity
+        tokenbucket_t(double rate, std::uint32_t burst = 1) ;
+
+        [[maybe_unused]] auto try_acquire(std::uint32_t count = 1) ->bool ;
+        auto deadline(std::uint32_t count = 1) const ->std::int64_t ;
+        auto available() const ->std::uint32_t ;
+    };
+}
+#endif /* ratelimit_hpp */
@@ -0,0 +1,164 @@
+//Copyright © 2023 Charles Kerr. All rights reserved.
+
+#include "seqfile.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+using namespace std::string_literals;
+
+namespace util {
+    namespace {
+        //=================================================================================
+        // Layout: magic(8) version(4) unused(4), then 64 byte entries of
+        // name(48, null padded) high water(8) unused(8)
+        constexpr char magic[8] = {'U','T','I','L','S','E','Q','1'} ;
+        constexpr std::uint32_t version = 1 ;
+        constexpr std::size_t header_size = 16 ;
+        constexpr std::size_t entry_size = 64 ;
+        constexpr std::size_t name_size = 48 ;
+    }
+    
+    //=================================================================================
+    // sequence_t
+    //=================================================================================
+    
+    //=================================================================================
+    seqfile_t::sequence_t::sequence_t(seqfile_t *file, std::size_t slot, std::uint64_t batch, std::uint64_t limit):file(file),slot(slot),batch(std::max<std::uint64_t>(batch,1)),limit(limit),current(0),reserved(0){
+        // Nothing past the high water mark was handed out, so we start there
+        auto high = file->high_water(slot) ;
+        current.store(high);
+        reserved.store(high);
+    }
+    //=================================================================================
+    // Moves the high water mark past value, and syncs it before anyone may use it
+    auto seqfile_t::sequence_t::reserve(std::uint64_t value) ->void {
+        auto lock = std::lock_guard(access);
+        auto high = reserved.load(std::memory_order_acquire) ;
+        if (high >= value){
+            return ;
+        }
+        auto top = value + (batch - 1) ;
+        if ((top < value) || (top > limit - 1)){
+            top = limit - 1 ;
+        }
+        file->checkpoint(slot, top);
+        reserved.store(top, std::memory_order_release);
+    }
+    //=================================================================================
+    auto seqfile_t::sequence_t::next() ->std::uint64_t {
+        auto value = current.fetch_add(1, std::memory_order_relaxed) + 1 ;
+        if ((value == 0) || (value >= limit)){
+            throw std::runtime_error("Numeric limit has been reached: "s + std::to_string(limit));
+        }
+        if (value > reserved.load(std::memory_order_acquire)){
+            reserve(value);
+        }
+        return value ;
+    }
+    //=================================================================================
+    auto seqfile_t::sequence_t::used(std::uint64_t value) ->sequence_t& {
+        auto now = current.load(std::memory_order_relaxed);
+        while ((now < value) && !current.compare_exchange_weak(now, value, std::memory_order_relaxed)){
+        }
+        if (value > reserved.load(std::memory_order_acquire)){
+            // Keep it across a restart too
+            reserve(std::min(value, limit - 1));
+        }
+        return *this ;
+    }
+    
+    //=================================================================================
+    // seqfile_t
+    //=================================================================================
+    
+    //=================================================================================
+    seqfile_t::seqfile_t(const std::filesystem::path &path) {
+        if (!std::filesystem::exists(path)){
+            auto page = std::vector<char>(page_size, 0) ;
+            std::copy(magic, magic + sizeof(magic), page.begin());
+            std::memcpy(page.data() + sizeof(magic), &version, sizeof(version));
+            auto output = std::ofstream(path.string(), std::ios::binary);
+            if (!output.is_open()){
+                throw std::runtime_error("Unable to create: "s + path.string());
+            }
+            output.write(page.data(), static_cast<std::streamsize>(page.size()));
+            output.close();
+            if (!output){
+                throw std::runtime_error("Unable to write: "s + path.string());
+            }
+        }
+        map.map(path, true);
+        if ((map.length < page_size) || !std::equal(magic, magic + sizeof(magic), map.ptr)){
+            throw std::runtime_error("Not a sequence checkpoint file: "s + path.string());
+        }
+    }
+    //=================================================================================
+    seqfile_t::~seqfile_t() {
+        try {
+            for (auto &[name,sequence] : sequences){
+                auto value = std::min(sequence->current.load(), sequence->reserved.load()) ;
+                std::memcpy(entry(sequence->slot) + name_size, &value, sizeof(value));
+            }
+            map.sync(0, page_size);
+        }
+        catch (...) {
+            // The high water marks already on disk are still safe
+        }
+    }
+    //=================================================================================
+    auto seqfile_t::entry(std::size_t slot) ->std::uint8_t* {
+        return map.ptr + header_size + slot * entry_size ;
+    }
+    //=================================================================================
+    auto seqfile_t::high_water(std::size_t slot) ->std::uint64_t {
+        auto value = std::uint64_t(0) ;
+        std::memcpy(&value, entry(slot) + name_size, sizeof(value));
+        return value ;
+    }
+    //=================================================================================
+    auto seqfile_t::checkpoint(std::size_t slot, std::uint64_t value) ->void {
+        std::memcpy(entry(slot) + name_size, &value, sizeof(value));
+        map.sync(0, page_size);
+    }
+    //=================================================================================
+    auto seqfile_t::sequence(const std::string &name, std::uint64_t batch, std::uint64_t limit) ->sequence_t& {
+        if (name.empty() || (name.size() > max_name)){
+            throw std::runtime_error("Sequence name must be 1 to "s + std::to_string(max_name) + " characters: "s + name);
+        }
+        auto lock = std::lock_guard(access);
+        auto iter = sequences.find(name) ;
+        if (iter != sequences.end()){
+            return *iter->second ;
+        }
+        auto slot = max_sequences ;
+        for (std::size_t i = 0 ; i < max_sequences ; ++i){
+            auto text = reinterpret_cast<const char*>(entry(i)) ;
+            if (text[0] == 0){
+                if (slot == max_sequences){
+                    slot = i ;
+                }
+                continue ;
+            }
+            if (name == std::string(text, std::find(text, text + name_size, 0))){
+                slot = i ;
+                break ;
+            }
+        }
+        if (slot == max_sequences){
+            throw std::runtime_error("Sequence file is full, unable to add: "s + name);
+        }
+        auto text = reinterpret_cast<char*>(entry(slot)) ;
+        if (text[0] == 0){
+            std::copy(name.begin(), name.end(), text);
+            map.sync(0, page_size);
+        }
+        auto sequence = std::make_unique<sequence_t>(this, slot, batch, limit) ;
+        auto &rvalue = *sequence ;
+        sequences.emplace(name, std::move(sequence));
+        return rvalue ;
+    }
+}
@@ -0,0 +1,66 @@
+//Copyright © 2023 Charles Kerr. All rights reserved.
+
+#ifndef seqfile_hpp
+#define seqfile_hpp
+
+#include <cstdint>
+#include <atomic>
+#include <filesystem>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "filemap.hpp"
+
+namespace util {
+    //=================================================================================
+    /* Durable id sequences, kept in a one page checkpoint file mapped with filemap_t.
+     A sequence reserves values in batches, and the top of each batch (its high water
+     mark) is written to the file and synced before any value in it is handed out.
+     After a crash a sequence resumes past its high water mark, so at most one unused
+     batch is lost, and startup reads a single page instead of scanning data.
+     One file holds up to max_sequences named sequences; it is meant for one process.
+     */
+    class seqfile_t {
+    public:
+        static constexpr std::size_t page_size = 4096 ;
+        static constexpr std::size_t max_name = 47 ;
+        static constexpr std::size_t max_sequences = 63 ;
+        
+        //=================================================================================
+        // Same next()/used()/limit semantics as numinc_t, thread safe
+        class sequence_t {
+            friend class seqfile_t ;
+            seqfile_t *file ;
+            std::size_t slot ;
+            std::uint64_t batch ;
+            std::uint64_t limit ;
+            std::atomic<std::uint64_t> current ;
+            std::atomic<std::uint64_t> reserved ;  // every value up to here is on disk
+            std::mutex access ;
+            auto reserve(std::uint64_t value) ->void ;
+        public:
+            sequence_t(seqfile_t *file, std::size_t slot, std::uint64_t batch, std::uint64_t limit) ;
+            auto next() ->std::uint64_t ;
+            auto used(std::uint64_t value) ->sequence_t& ;
+        };
+    private:
+        filemap_t map ;
+        std::mutex access ;
+        std::map<std::string,std::unique_ptr<sequence_t>> sequences ;
+        
+        auto entry(std::size_t slot) ->std::uint8_t* ;
+        auto high_water(std::size_t slot) ->std::uint64_t ;
+        auto checkpoint(std::size_t slot, std::uint64_t value) ->void ;
+    public:
+        // Creates the file if it does not exist
+        seqfile_t(const std::filesystem::path &path) ;
+        // A clean shutdown records exactly what was used, so nothing is lost
+        ~seqfile_t() ;
+        // The named sequence, made on first use; batch and limit are taken from the first call
+        auto sequence(const std::string &name, std::uint64_t batch = 1024, std::uint64_t limit = std::numeric_limits<std::uint64_t>::max()) ->sequence_t& ;
+    };
+}
+#endif /* seqfile_hpp */
@@ -0,0 +1,173 @@
+//Copyright © 2023 Charles Kerr. All rights reserved.
+
+#ifndef slotmap_hpp
+#define slotmap_hpp
+
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "numinc.hpp"
+
+namespace util {
+    //=================================================================================
+    /* Container keyed by generational handles instead of ids in a hash map.
+     A handle is a slot index plus the slot's version; erasing bumps the version, so an
+     old handle is detected as stale rather than finding whatever reused the slot.
+     Values are kept packed in one vector (erase moves the last value into the gap), so
+     iterating runs over contiguous memory, in no particular order.
+     Slot indices come from a numinc_t, with the same limit and the same exception once it
+     is reached. Index 0 is never issued, a default handle_t is never valid.
+     */
+    template <typename V, typename T = std::uint32_t>
+    class slotmap_t {
+        static_assert(std::is_integral_v<T> && std::is_unsigned_v<T>,
+                      "slotmap_t requires unsigned integral index types");
+    public:
+        struct handle_t {
+            T index = 0 ;
+            T version = 0 ;
+            auto operator==(const handle_t &other) const ->bool { return (index == other.index) && (version == other.version); }
+            auto operator!=(const handle_t &other) const ->bool { return !(*this == other); }
+        };
+    private:
+        static constexpr auto none = std::numeric_limits<T>::max() ;
+        struct slot_t {
+            T version ;
+            T position ;    // into values when in use, else the next free slot (none ends the list)
+        };
+        std::vector<slot_t> slots ;
+        std::vector<V> values ;
+        std::vector<T> owners ;     // the slot of each value
+        T free_slot ;
+        numinc_t<T> indices ;
+
+        auto find(const handle_t &handle) const ->const slot_t* {
+            if ((handle.index == 0) || (handle.index >= slots.size())){
+                return nullptr ;
+            }
+            const auto &slot = slots[handle.index] ;
+            // An even version is a free slot, a handle only ever holds an odd one
+            return ((slot.version == handle.version) && ((slot.version & 1) != 0)) ? &slot : nullptr ;
+        }
+        auto acquire() ->T {
+            if (free_slot != none){
+                auto index = free_slot ;
+                free_slot = slots[index].position ;
+                return index ;
+            }
+            auto index = indices.next() ;
+            if (slots.size() <= index){
+                slots.resize(static_cast<std::size_t>(index) + 1, slot_t{0,none});
+            }
+            return index ;
+        }
+    public:
+        template <typename... Args>
+        auto emplace(Args&&... args) ->handle_t {
+            auto index = acquire() ;
+            try {
+                values.emplace_back(std::forward<Args>(args)...);
+            }
+            catch (...){
+                slots[index].position = free_slot ;
+                free_slot = index ;
+                throw ;
+            }
+            owners.push_back(index);
+            auto &slot = slots[index] ;
+            slot.version++ ;
+            slot.position = static_cast<T>(values.size() - 1) ;
+            return handle_t{index, slot.version} ;
+        }
+        auto insert(const V &value) ->handle_t {
+            return emplace(value);
+        }
+        auto insert(V &&value) ->handle_t {
+            return emplace(std::move(value));
+        }
+        // Returns false if the handle is stale
+        auto erase(const handle_t &handle) ->bool {
+            if (find(handle) == nullptr){
+                return false ;
+            }
+            auto &slot = slots[handle.index] ;
+            auto position = slot.position ;
+            auto last = values.size() - 1 ;
+            if (position != last){
+                values[position] = std::move(values[last]);
+                owners[position] = owners[last] ;
+                slots[owners[position]].position = position ;
+            }
+            values.pop_back();
+            owners.pop_back();
+            slot.version++ ;
+            // A slot whose version would wrap is retired, so old handles can never match again
+            if (slot.version != none - 1){
+                slot.position = free_slot ;
+                free_slot = handle.index ;
+            }
+            return true ;
+        }
+        // nullptr if the handle is stale, the pointer is good until the next insert or erase
+        auto get(const handle_t &handle) ->V* {
+            auto slot = find(handle) ;
+            return (slot == nullptr) ? nullptr : &values[slot->position] ;
+        }
+        auto get(const handle_t &handle) const ->const V* {
+            auto slot = find(handle) ;
+            return (slot == nullptr) ? nullptr : &values[slot->position] ;
+        }
+        auto at(const handle_t &handle) ->V& {
+            auto value = get(handle) ;
+            if (value == nullptr){
+                throw std::out_of_range(std::string("Stale slot map handle: ") + std::to_string(handle.index));
+            }
+            return *value ;
+        }
+        auto at(const handle_t &handle) const ->const V& {
+            auto value = get(handle) ;
+            if (value == nullptr){
+                throw std::out_of_range(std::string("Stale slot map handle: ") + std::to_string(handle.index));
+            }
+            return *value ;
+        }
+        auto contains(const handle_t &handle) const ->bool {
+            return find(handle) != nullptr ;
+        }
+        // Handle of the value at a position in the packed order
+        auto handle(std::size_t position) const ->handle_t {
+            auto index = owners[position] ;
+            return handle_t{index, slots[index].version} ;
+        }
+        auto size() const ->std::size_t {
+            return values.size();
+        }
+        auto empty() const ->bool {
+            return values.empty();
+        }
+        auto clear() ->void {
+            while (!values.empty()){
+                erase(handle(values.size() - 1));
+            }
+        }
+        auto reserve(std::size_t count) ->void {
+            values.reserve(count);
+            owners.reserve(count);
+        }
+
+        auto begin() { return values.begin(); }
+        auto end() { return values.end(); }
+        auto begin() const { return values.begin(); }
+        auto end() const { return values.end(); }
+
+        slotmap_t(T max_value = none):free_slot(none),indices(0, max_value){
+            slots.push_back(slot_t{0,none});
+        }
+    };
+}
+#endif /* slotmap_hpp */
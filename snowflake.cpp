@@ -0,0 +1,61 @@
+//Copyright © 2023 Charles Kerr. All rights reserved.
+
+#include "snowflake.hpp"
+
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+using namespace std::string_literals;
+
+namespace util {
+    //=================================================================================
+    snowflake_t::snowflake_t(std::uint64_t node, int node_bits, int sequence_bits, std::int64_t epoch):last(0),start(0),epoch(epoch),node_part(0),node_bits(node_bits),sequence_bits(sequence_bits){
+        if ((node_bits < 0) || (sequence_bits < 1) || (node_bits + sequence_bits > 32)){
+            throw std::runtime_error("Invalid snowflake layout, node bits: "s + std::to_string(node_bits) + " sequence bits: "s + std::to_string(sequence_bits));
+        }
+        if (node >= (std::uint64_t(1) << node_bits)){
+            throw std::runtime_error("Snowflake node does not fit in "s + std::to_string(node_bits) + " bits: "s + std::to_string(node));
+        }
+        auto wall = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        if (wall < epoch){
+            throw std::runtime_error("Snowflake epoch is in the future: "s + std::to_string(epoch));
+        }
+        start = wall - epoch ;
+        clock.start();
+        node_part = node << sequence_bits ;
+    }
+    //=================================================================================
+    auto snowflake_t::next() ->std::uint64_t {
+        auto now = static_cast<std::uint64_t>(start + clock.elapsed()) << sequence_bits ;
+        auto previous = last.load(std::memory_order_relaxed);
+        auto value = previous ;
+        while (true){
+            // A new millisecond restarts the sequence, otherwise count on (into the next
+            // millisecond if the sequence is used up)
+            value = (now > previous) ? now : previous + 1 ;
+            if ((value >> sequence_bits) > (now >> sequence_bits) + max_lead){
+                // Borrowed as far ahead as allowed, wait for the clock
+                std::this_thread::yield();
+                now = static_cast<std::uint64_t>(start + clock.elapsed()) << sequence_bits ;
+                previous = last.load(std::memory_order_relaxed);
+                continue ;
+            }
+            if (last.compare_exchange_weak(previous, value, std::memory_order_relaxed)){
+                break ;
+            }
+        }
+        auto sequence = value & ((std::uint64_t(1) << sequence_bits) - 1) ;
+        auto milliseconds = value >> sequence_bits ;
+        return (milliseconds << (node_bits + sequence_bits)) | node_part | sequence ;
+    }
+    //=================================================================================
+    auto snowflake_t::decode(std::uint64_t id) const ->parts_t {
+        auto parts = parts_t() ;
+        parts.sequence = id & ((std::uint64_t(1) << sequence_bits) - 1) ;
+        parts.node = (id >> sequence_bits) & ((std::uint64_t(1) << node_bits) - 1) ;
+        parts.milliseconds = static_cast<std::int64_t>(id >> (node_bits + sequence_bits)) + epoch ;
+        return parts ;
+    }
+}
@@ -0,0 +1,50 @@
+//Copyright © 2023 Charles Kerr. All rights reserved.
+
+#ifndef snowflake_hpp
+#define snowflake_hpp
+
+#include <cstdint>
+#include <atomic>
+
+#include "timer.hpp"
+
+namespace util {
+    //=================================================================================
+    /* Time ordered, roughly sortable 64 bit ids, unique across nodes without coordination:
+     [ milliseconds since epoch | node | sequence within the millisecond ]
+     The default split is 41/10/12 bits (69 years, 1024 nodes, 4096 ids per millisecond).
+     Time is the wall clock read once at construction, then moved on by a timer_t (the
+     monotonic clock), so a wall clock step backwards never repeats an id. When a
+     millisecond's sequence runs out, the next ids borrow from the following millisecond,
+     but never more than max_lead ahead of the clock: past that next() yields until the
+     clock catches up. The lead is bounded because a generator made later for the same
+     node starts from the wall clock, and would repeat any ids issued ahead of it (so
+     let max_lead pass before starting a node again). Below the limit next() is lock
+     free, one compare and swap.
+     */
+    class snowflake_t {
+    public:
+        // 2020-01-01T00:00:00Z in unix milliseconds
+        static constexpr std::int64_t default_epoch = 1577836800000 ;
+        // Milliseconds the timestamp may run ahead of the clock
+        static constexpr std::uint64_t max_lead = 1 ;
+        struct parts_t {
+            std::int64_t milliseconds ;  // unix time
+            std::uint64_t node ;
+            std::uint64_t sequence ;
+        };
+    private:
+        std::atomic<std::uint64_t> last ;  // (milliseconds << sequence_bits) | sequence of the last id
+        timer_t clock ;
+        std::int64_t start ;               // milliseconds since epoch when clock started
+        std::int64_t epoch ;
+        std::uint64_t node_part ;
+        int node_bits ;
+        int sequence_bits ;
+    public:
+        snowflake_t(std::uint64_t node, int node_bits = 10, int sequence_bits = 12, std::int64_t epoch = default_epoch) ;
+        auto next() ->std::uint64_t ;
+        auto decode(std::uint64_t id) const ->parts_t ;
+    };
+}
+#endif /* snowflake_hpp */
@@ -9,14 +9,21 @@
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
 
 #include <array>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
 #include <charconv>
 #include <chrono>
 #include <memory>
 #include <ostream>
+#include <stdexcept>
 #include <system_error>
 #include <type_traits>
 #include <vector>
@@ -28,79 +35,493 @@
 #undef min
 #endif
 #endif
+#if defined(__AVX2__)
+#define STRUTIL_AVX2 1
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define STRUTIL_SSE2 1
+#endif
+#if defined(__SSSE3__) || defined(STRUTIL_AVX2)
+#define STRUTIL_SSSE3 1
+#endif
+#if defined(STRUTIL_SSE2) || defined(STRUTIL_AVX2)
+#include <immintrin.h>
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#if (defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)) || defined(_WIN32)
+#define STRUTIL_LITTLE_ENDIAN 1
+#endif
 //=========================================================
 namespace strutil {
+    //=========================================================
+    // Whitespace scanning kernels (" \t\v\f\n\r")
+    //=========================================================
+    namespace detail {
+        //=========================================================
+        inline constexpr auto is_space(char ch) -> bool {
+            return (ch == ' ') || (static_cast<unsigned char>(ch - '\t') < 5);
+        }
+#if defined(STRUTIL_SSE2)
+        //=========================================================
+        // 0xFF in each whitespace byte
+        inline auto space_bytes16(__m128i bytes) -> __m128i {
+            auto control = _mm_sub_epi8(bytes, _mm_set1_epi8('\t'));
+            auto in_range = _mm_cmpeq_epi8(_mm_min_epu8(control, _mm_set1_epi8(4)), control);
+            return _mm_or_si128(in_range, _mm_cmpeq_epi8(bytes, _mm_set1_epi8(' ')));
+        }
+        //=========================================================
+        // Mask with a bit set for each whitespace byte of the 16 at data
+        inline auto space_mask16(const char *data) -> std::uint32_t {
+            auto bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data));
+            return static_cast<std::uint32_t>(_mm_movemask_epi8(space_bytes16(bytes)));
+        }
+#endif
+#if defined(STRUTIL_AVX2)
+        //=========================================================
+        inline auto space_mask32(const char *data) -> std::uint32_t {
+            auto bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data));
+            auto control = _mm256_sub_epi8(bytes, _mm256_set1_epi8('\t'));
+            auto in_range = _mm256_cmpeq_epi8(_mm256_min_epu8(control, _mm256_set1_epi8(4)), control);
+            auto blank = _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(' '));
+            return static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_or_si256(in_range, blank)));
+        }
+#endif
+        //=========================================================
+        inline auto count_trailing_zeros(std::uint32_t mask) -> int {
+#if defined(_MSC_VER)
+            unsigned long index;
+            _BitScanForward(&index, mask);
+            return static_cast<int>(index);
+#else
+            return __builtin_ctz(mask);
+#endif
+        }
+        //=========================================================
+        inline auto count_trailing_zeros(std::uint64_t mask) -> int {
+#if defined(_MSC_VER)
+            unsigned long index;
+            _BitScanForward64(&index, mask);
+            return static_cast<int>(index);
+#else
+            return __builtin_ctzll(mask);
+#endif
+        }
+        //=========================================================
+        inline auto count_leading_zeros(std::uint32_t mask) -> int {
+#if defined(_MSC_VER)
+            unsigned long index;
+            _BitScanReverse(&index, mask);
+            return 31 - static_cast<int>(index);
+#else
+            return __builtin_clz(mask);
+#endif
+        }
+        //=========================================================
+        // Offset of the first non whitespace character, length if there is none
+        inline auto first_not_space(const char *data, std::size_t length) -> std::size_t {
+            auto index = std::size_t(0);
+            // Most fields have no or little padding, so look before loading vectors
+            while ((index < length) && (index < 4)) {
+                if (!is_space(data[index])) {
+                    return index;
+                }
+                ++index;
+            }
+#if defined(STRUTIL_AVX2)
+            for (; index + 32 <= length; index += 32) {
+                auto mask = ~space_mask32(data + index);
+                if (mask != 0) {
+                    return index + static_cast<std::size_t>(count_trailing_zeros(mask));
+                }
+            }
+#endif
+#if defined(STRUTIL_SSE2)
+            for (; index + 16 <= length; index += 16) {
+                auto mask = ~space_mask16(data + index) & 0xFFFF;
+                if (mask != 0) {
+                    return index + static_cast<std::size_t>(count_trailing_zeros(mask));
+                }
+            }
+#endif
+            while ((index < length) && is_space(data[index])) {
+                ++index;
+            }
+            return index;
+        }
+        //=========================================================
+        // Offset just past the last non whitespace character, 0 if there is none
+        inline auto last_not_space(const char *data, std::size_t length) -> std::size_t {
+            auto end = length;
+            while ((end > 0) && (length - end < 4)) {
+                if (!is_space(data[end - 1])) {
+                    return end;
+                }
+                --end;
+            }
+#if defined(STRUTIL_AVX2)
+            for (; end >= 32; end -= 32) {
+                auto mask = ~space_mask32(data + end - 32);
+                if (mask != 0) {
+                    return end - static_cast<std::size_t>(count_leading_zeros(mask));
+                }
+            }
+#endif
+#if defined(STRUTIL_SSE2)
+            for (; end >= 16; end -= 16) {
+                auto mask = ~space_mask16(data + end - 16) & 0xFFFF;
+                if (mask != 0) {
+                    return end - static_cast<std::size_t>(count_leading_zeros(mask) - 16);
+                }
+            }
+#endif
+            while ((end > 0) && is_space(data[end - 1])) {
+                --end;
+            }
+            return end;
+        }
+        //=========================================================
+        // Shuffle indices that pack the bytes selected by an 8 bit mask
+        // to the front, one byte per index, the rest zero
+        inline constexpr auto make_compress_table() -> std::array<std::uint64_t, 256> {
+            auto table = std::array<std::uint64_t, 256>{};
+            for (std::size_t mask = 0; mask < 256; ++mask) {
+                auto entry = std::uint64_t(0);
+                auto slot = 0;
+                for (auto bit = 0; bit < 8; ++bit) {
+                    if ((mask & (std::size_t(1) << bit)) != 0) {
+                        entry |= static_cast<std::uint64_t>(bit) << (8 * slot++);
+                    }
+                }
+                table[mask] = entry;
+            }
+            return table;
+        }
+        inline constexpr auto compress_table = make_compress_table();
+        //=========================================================
+        inline auto popcount8(std::uint32_t mask) -> int {
+            mask = mask - ((mask >> 1) & 0x55);
+            mask = (mask & 0x33) + ((mask >> 2) & 0x33);
+            return static_cast<int>((mask + (mask >> 4)) & 0x0F);
+        }
+        //=========================================================
+        // Offset of the first ch, length if there is none
+        inline auto find_byte(const char *data, std::size_t length, char ch) -> std::size_t {
+            auto index = std::size_t(0);
+#if defined(STRUTIL_SSE2)
+            auto wanted = _mm_set1_epi8(ch);
+            for (; index + 16 <= length; index += 16) {
+                auto bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + index));
+                auto mask = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, wanted)));
+                if (mask != 0) {
+                    return index + static_cast<std::size_t>(count_trailing_zeros(mask));
+                }
+            }
+#endif
+            while ((index < length) && (data[index] != ch)) {
+                ++index;
+            }
+            return index;
+        }
+        //=========================================================
+        // Offset of the first pattern in data, length if there is none.
+        // Blocks are screened on the pattern's first and last bytes
+        // together, only the places where both agree are compared
+        inline auto find_pattern(const char *data, std::size_t length, const char *pattern, std::size_t size) -> std::size_t {
+            if (size == 0) {
+                return 0;
+            }
+            if (size > length) {
+                return length;
+            }
+            if (size == 1) {
+                return find_byte(data, length, pattern[0]);
+            }
+            // Starts [0,starts) are possible
+            auto starts = length - size + 1;
+            auto index = std::size_t(0);
+#if defined(STRUTIL_AVX2)
+            {
+                auto first = _mm256_set1_epi8(pattern[0]);
+                auto last = _mm256_set1_epi8(pattern[size - 1]);
+                for (; index + 32 <= starts; index += 32) {
+                    auto head = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + index));
+                    auto tail = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + index + size - 1));
+                    auto mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(head, first), _mm256_cmpeq_epi8(tail, last))));
+                    while (mask != 0) {
+                        auto at = index + static_cast<std::size_t>(count_trailing_zeros(mask));
+                        if (std::memcmp(data + at + 1, pattern + 1, size - 2) == 0) {
+                            return at;
+                        }
+                        mask &= mask - 1;
+                    }
+                }
+            }
+#endif
+#if defined(STRUTIL_SSE2)
+            {
+                auto first = _mm_set1_epi8(pattern[0]);
+                auto last = _mm_set1_epi8(pattern[size - 1]);
+                for (; index + 16 <= starts; index += 16) {
+                    auto head = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + index));
+                    auto tail = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + index + size - 1));
+                    auto mask = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(head, first), _mm_cmpeq_epi8(tail, last))));
+                    while (mask != 0) {
+                        auto at = index + static_cast<std::size_t>(count_trailing_zeros(mask));
+                        if (std::memcmp(data + at + 1, pattern + 1, size - 2) == 0) {
+                            return at;
+                        }
+                        mask &= mask - 1;
+                    }
+                }
+            }
+#endif
+            for (; index < starts; ++index) {
+                if ((data[index] == pattern[0]) && (data[index + size - 1] == pattern[size - 1]) && (std::memcmp(data + index + 1, pattern + 1, size - 2) == 0)) {
+                    return index;
+                }
+            }
+            return length;
+        }
+    } // namespace detail
+
     //=========================================================
     // Trim utilities
     //=========================================================
     
+    // Trim all whitespace from the left of the view (the result views the same characters)
+    inline auto ltrim(std::string_view value) -> std::string_view {
+        value.remove_prefix(detail::first_not_space(value.data(), value.size()));
+        return value;
+    }
+    //=========================================================
+    // Trim all whitespace from the right of the view
+    inline auto rtrim(std::string_view value) -> std::string_view {
+        return value.substr(0, detail::last_not_space(value.data(), value.size()));
+    }
+    //=========================================================
+    // Trim all whitespace from both sides of the view
+    inline auto trim(std::string_view value) -> std::string_view {
+        return rtrim(ltrim(value));
+    }
+    //=========================================================
     // Trim all whitespace from the left of the string
     inline auto ltrim(const std::string &value) -> std::string {
-        if (!value.empty()) {
-            auto loc = value.find_first_not_of(" \t\v\f\n\r");
-            if (loc == std::string::npos) {
-                return std::string();
-            }
-            return value.substr(loc);
-        }
-        return value;
+        return std::string(ltrim(std::string_view(value)));
     }
     //=========================================================
     // Trim all whitespace from the right of the string
     inline auto rtrim(const std::string &value) -> std::string {
-        if (!value.empty()) {
-            auto loc = value.find_last_not_of(" \t\v\f\n\r");
-            if (loc == std::string::npos) {
-                return value;
-            }
-            return value.substr(0, loc + 1);
-        }
-        return value;
+        return std::string(rtrim(std::string_view(value)));
     }
     //=========================================================
     // Trim all whitespace from both sides of the string
     inline auto trim(const std::string &value) -> std::string {
-        return rtrim(ltrim(value));
+        return std::string(trim(std::string_view(value)));
+    }
+    //=========================================================
+    // Plain character strings would be ambiguous between the two above,
+    // they keep returning strings
+    inline auto ltrim(const char *value) -> std::string {
+        return std::string(ltrim(std::string_view(value)));
+    }
+    inline auto rtrim(const char *value) -> std::string {
+        return std::string(rtrim(std::string_view(value)));
+    }
+    inline auto trim(const char *value) -> std::string {
+        return std::string(trim(std::string_view(value)));
     }
     
     //=========================================================
     // Trim all whitespace from both sides of the string.
     // In addition, replace all runs of whitespace inside the string
-    // with a single space character
-    inline auto simplify(const std::string &value) -> std::string {
-        // first get the leading/trailing whitespace off
-        auto working = trim(value);
-        if (!working.empty()) {
-            auto startloc = working.find_first_of(" \t\v\f\n\r");
-            while ((startloc != std::string::npos) && (startloc < working.size())) {
-                auto endloc = working.find_first_not_of(" \t\v\f\n\r", startloc);
-                auto amount = endloc - startloc;
-                working.replace(startloc, amount, std::string(" "));
-                startloc = working.find_first_of(" \t\v\f\n\r", startloc + 1);
+    // with a single space character.
+    // Writes the result to output (which may be value.data(), to work in
+    // place, otherwise room for value.size() characters), returns its length
+    inline auto simplify(std::string_view value, char *output) -> std::size_t {
+        value = trim(value);
+        auto input = value.data();
+        auto length = value.size();
+        auto index = std::size_t(0);
+        auto count = std::size_t(0);
+        // The trimmed value starts with a non whitespace character
+        auto previous_space = false;
+#if defined(STRUTIL_SSSE3)
+        for (; index + 16 <= length; index += 16) {
+            auto bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input + index));
+            auto space_bytes = detail::space_bytes16(bytes);
+            auto spaces = static_cast<std::uint32_t>(_mm_movemask_epi8(space_bytes));
+            if (spaces == 0) {
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(output + count), bytes);
+                count += 16;
+                previous_space = false;
+                continue;
+            }
+            // A whitespace byte is dropped when the one before it was whitespace too
+            auto keep = ~(spaces & ((spaces << 1) | (previous_space ? 1u : 0u))) & 0xFFFF;
+            previous_space = (spaces & 0x8000) != 0;
+            // Whitespace becomes ' ', then the kept bytes of each half are packed down
+            bytes = _mm_or_si128(_mm_andnot_si128(space_bytes, bytes), _mm_and_si128(space_bytes, _mm_set1_epi8(' ')));
+            auto low = detail::compress_table[keep & 0xFF];
+            auto high = detail::compress_table[keep >> 8] + 0x0808080808080808ull;
+            auto packed = _mm_shuffle_epi8(bytes, _mm_set_epi64x(static_cast<long long>(high), static_cast<long long>(low)));
+            // 8 byte stores, so working in place never writes past what has been read
+            _mm_storel_epi64(reinterpret_cast<__m128i *>(output + count), packed);
+            count += static_cast<std::size_t>(detail::popcount8(keep & 0xFF));
+            _mm_storel_epi64(reinterpret_cast<__m128i *>(output + count), _mm_unpackhi_epi64(packed, packed));
+            count += static_cast<std::size_t>(detail::popcount8(keep >> 8));
+        }
+#endif
+        for (; index < length; ++index) {
+            auto ch = input[index];
+            if (detail::is_space(ch)) {
+                if (!previous_space) {
+                    output[count++] = ' ';
+                }
+                previous_space = true;
+            }
+            else {
+                output[count++] = ch;
+                previous_space = false;
             }
         }
-        return working;
+        return count;
+    }
+    //=========================================================
+    // simplify() on the string itself
+    inline auto simplify_in_place(std::string &value) -> void {
+        value.resize(simplify(value, value.data()));
+    }
+    //=========================================================
+    inline auto simplify(std::string_view value) -> std::string {
+        auto rvalue = std::string(value.size(), ' ');
+        rvalue.resize(simplify(value, rvalue.data()));
+        return rvalue;
     }
     
     //=========================================================
     // Case utilities
+    // Only ASCII letters change, every other byte (so any UTF-8
+    // multibyte sequence) passes through as is, whatever the locale
     //=========================================================
+    namespace detail {
+        //=========================================================
+        // Flips the case of bytes in [first, first+26), 'a' for upper, 'A' for lower
+        inline auto convert_case(const char *input, char *output, std::size_t length, char first) -> void {
+            auto index = std::size_t(0);
+#if defined(STRUTIL_AVX2)
+            auto start32 = _mm256_set1_epi8(first);
+            auto span32 = _mm256_set1_epi8(25);
+            auto bit32 = _mm256_set1_epi8(0x20);
+            for (; index + 32 <= length; index += 32) {
+                auto bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(input + index));
+                auto offset = _mm256_sub_epi8(bytes, start32);
+                auto letters = _mm256_cmpeq_epi8(_mm256_min_epu8(offset, span32), offset);
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(output + index), _mm256_xor_si256(bytes, _mm256_and_si256(letters, bit32)));
+            }
+#endif
+#if defined(STRUTIL_SSE2)
+            auto start16 = _mm_set1_epi8(first);
+            auto span16 = _mm_set1_epi8(25);
+            auto bit16 = _mm_set1_epi8(0x20);
+            for (; index + 16 <= length; index += 16) {
+                auto bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input + index));
+                auto offset = _mm_sub_epi8(bytes, start16);
+                auto letters = _mm_cmpeq_epi8(_mm_min_epu8(offset, span16), offset);
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(output + index), _mm_xor_si128(bytes, _mm_and_si128(letters, bit16)));
+            }
+#endif
+            for (; index < length; ++index) {
+                auto ch = input[index];
+                output[index] = (static_cast<unsigned char>(ch - first) < 26) ? static_cast<char>(ch ^ 0x20) : ch;
+            }
+        }
+        //=========================================================
+        // ASCII lower case of 8 bytes at once
+        inline auto fold_word(std::uint64_t word) -> std::uint64_t {
+            constexpr auto ones = std::uint64_t(0x0101010101010101);
+            auto low7 = word & (0x7F * ones);
+            auto upper = ((low7 + (0x80 - 'A') * ones) ^ (low7 + (0x80 - 'Z' - 1) * ones)) & ~word & (0x80 * ones);
+            return word | (upper >> 2);
+        }
+        //=========================================================
+        // Up to 8 bytes as a word, zero filled
+        inline auto load_word(const char *data, std::size_t length) -> std::uint64_t {
+            auto word = std::uint64_t(0);
+            std::memcpy(&word, data, std::min<std::size_t>(length, 8));
+            return word;
+        }
+    } // namespace detail
     
+    //=========================================================
+    // Upper case value into output (room for value.size(), may be value.data())
+    inline auto upper(std::string_view value, char *output) -> void {
+        detail::convert_case(value.data(), output, value.size(), 'a');
+    }
+    //=========================================================
+    inline auto lower(std::string_view value, char *output) -> void {
+        detail::convert_case(value.data(), output, value.size(), 'A');
+    }
+    //=========================================================
+    inline auto upper_in_place(std::string &value) -> void {
+        upper(value, value.data());
+    }
+    //=========================================================
+    inline auto lower_in_place(std::string &value) -> void {
+        lower(value, value.data());
+    }
+    //=========================================================
     inline auto upper(const std::string &value) -> std::string {
-        std::string rvalue;
-        std::transform(value.begin(), value.end(), std::back_inserter(rvalue),
-                       [](unsigned char c) { return std::toupper(c); } // correct
-                       );
+        auto rvalue = std::string(value.size(), ' ');
+        upper(value, rvalue.data());
         return rvalue;
     }
     //========================================================================
     inline auto lower(const std::string &value) -> std::string {
-        std::string rvalue;
-        std::transform(value.begin(), value.end(), std::back_inserter(rvalue),
-                       [](unsigned char c) { return std::tolower(c); } // correct
-                       );
+        auto rvalue = std::string(value.size(), ' ');
+        lower(value, rvalue.data());
         return rvalue;
     }
+    //=========================================================
+    // Compare ignoring ASCII case, without making lowered copies
+    inline auto iequals(std::string_view lhs, std::string_view rhs) -> bool {
+        if (lhs.size() != rhs.size()) {
+            return false;
+        }
+        auto index = std::size_t(0);
+        for (; index + 8 <= lhs.size(); index += 8) {
+            if (detail::fold_word(detail::load_word(lhs.data() + index, 8)) != detail::fold_word(detail::load_word(rhs.data() + index, 8))) {
+                return false;
+            }
+        }
+        return detail::fold_word(detail::load_word(lhs.data() + index, lhs.size() - index)) == detail::fold_word(detail::load_word(rhs.data() + index, rhs.size() - index));
+    }
+    //=========================================================
+    // Hash ignoring ASCII case (values that are iequals() hash the same)
+    inline auto ihash(std::string_view value) -> std::size_t {
+        constexpr auto multiplier = std::uint64_t(0x9E3779B97F4A7C15);
+        auto hash = static_cast<std::uint64_t>(value.size()) * multiplier;
+        auto index = std::size_t(0);
+        for (; index + 8 <= value.size(); index += 8) {
+            hash = (hash ^ detail::fold_word(detail::load_word(value.data() + index, 8))) * multiplier;
+            hash ^= hash >> 29;
+        }
+        if (index < value.size()) {
+            hash = (hash ^ detail::fold_word(detail::load_word(value.data() + index, value.size() - index))) * multiplier;
+        }
+        hash ^= hash >> 32;
+        return static_cast<std::size_t>(hash);
+    }
+    //=========================================================
+    // For containers keyed without case,
+    //     std::unordered_map<std::string, T, strutil::ihash_t, strutil::iequal_t>
+    struct ihash_t {
+        auto operator()(std::string_view value) const -> std::size_t { return ihash(value); }
+    };
+    struct iequal_t {
+        auto operator()(std::string_view lhs, std::string_view rhs) const -> bool { return iequals(lhs, rhs); }
+    };
     
     //=========================================================
     // String manipulation (remove remaining based on separator,
@@ -139,29 +560,329 @@ namespace strutil {
         return std::make_pair(first, second);
     }
     
+    //=========================================================
+    // Lazy parse(): a range of trimmed views of the fields of value,
+    // allocating nothing. The views point into value, which must outlive them.
+    //     for (auto field : strutil::tokens(line, ",")) { ... }
+    // Gives the same fields as parse(), separators are searched for
+    // 16 bytes at a time
+    class tokens_t {
+        std::string_view value;
+        std::string_view sep;
+    public:
+        class iterator {
+            std::string_view rest;
+            std::string_view sep;
+            std::string_view token;
+            bool more = false;      // is there a field after token
+            bool done = true;
+            
+            auto advance() -> void {
+                if (!more) {
+                    done = true;
+                    return;
+                }
+                auto loc = detail::find_pattern(rest.data(), rest.size(), sep.data(), sep.size());
+                if (loc >= rest.size()) {
+                    token = trim(rest);
+                    rest = std::string_view();
+                    more = false;
+                }
+                else {
+                    token = trim(rest.substr(0, loc));
+                    rest.remove_prefix(loc + sep.size());
+                }
+            }
+        public:
+            using iterator_category = std::input_iterator_tag;
+            using value_type = std::string_view;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const std::string_view *;
+            using reference = const std::string_view &;
+            
+            iterator() = default;
+            iterator(std::string_view value, std::string_view sep) : rest(value), sep(sep), more(true), done(false) {
+                if (sep.empty()) {
+                    // The whole value is the one field
+                    rest = std::string_view();
+                    token = trim(value);
+                    more = false;
+                    return;
+                }
+                if (value.empty()) {
+                    done = true;
+                    return;
+                }
+                advance();
+            }
+            auto operator*() const -> reference { return token; }
+            auto operator->() const -> pointer { return &token; }
+            auto operator++() -> iterator & {
+                advance();
+                return *this;
+            }
+            auto operator++(int) -> iterator {
+                auto rvalue = *this;
+                advance();
+                return rvalue;
+            }
+            auto operator==(const iterator &other) const -> bool {
+                return (done == other.done) && (done || ((rest.data() == other.rest.data()) && (more == other.more)));
+            }
+            auto operator!=(const iterator &other) const -> bool { return !(*this == other); }
+        };
+        
+        tokens_t(std::string_view value, std::string_view sep) : value(value), sep(sep) {}
+        auto begin() const -> iterator { return iterator(value, sep); }
+        auto end() const -> iterator { return iterator(); }
+    };
+    //=========================================================
+    inline auto tokens(std::string_view value, std::string_view sep) -> tokens_t {
+        return tokens_t(value, sep);
+    }
+    
     //=========================================================
     inline auto parse(const std::string &value, const std::string &sep) -> std::vector<std::string> {
         std::vector<std::string> rvalue;
-        auto current = std::string::size_type(0);
-        if (!sep.empty()){
-            auto loc = value.find(sep, current);
-            while (loc != std::string::npos) {
-                rvalue.push_back(trim(value.substr(current, loc - current)));
-                current = loc + sep.size();
-                if (current >= value.size()){
-                    rvalue.push_back("");
+        for (auto field : tokens(value, sep)) {
+            rvalue.emplace_back(field);
+        }
+        return rvalue;
+    }
+    //=========================================================
+    // parse() into an output iterator taking std::string_view,
+    // returns the iterator past the last field written
+    template <typename OutputIt>
+    auto parse(std::string_view value, std::string_view sep, OutputIt output) -> OutputIt {
+        for (auto field : tokens(value, sep)) {
+            *output++ = field;
+        }
+        return output;
+    }
+    
+    //=========================================================
+    // Substring search
+    //=========================================================
+    
+    //=========================================================
+    // Offset of the first pattern in text at or after pos, npos if there
+    // is none (as std::string_view::find, but screening 16 or 32 bytes
+    // at a time)
+    inline auto find(std::string_view text, std::string_view pattern, std::size_t pos = 0) -> std::size_t {
+        if (pos > text.size()) {
+            return std::string_view::npos;
+        }
+        auto loc = detail::find_pattern(text.data() + pos, text.size() - pos, pattern.data(), pattern.size());
+        return (pos + loc + pattern.size() > text.size()) ? std::string_view::npos : pos + loc;
+    }
+    
+    //=========================================================
+    // Finds every occurrence of any of a set of patterns in one pass
+    // over the text (Aho-Corasick), however many patterns there are.
+    //     auto keywords = strutil::matcher_t({"error", "warning", "fatal"});
+    //     keywords.scan(text, [](strutil::matcher_t::match_t match) { ... });
+    // Pattern ids are their positions in the set given. Overlapping
+    // matches are all reported, in order of where they end.
+    // The automaton is a dense table of states by byte classes (bytes
+    // in no pattern share one class), entries are the next row's offset
+    // with the low bit saying the state ends a pattern, so a byte costs
+    // two loads. A stream_t carries the state from chunk to chunk, for
+    // text that arrives in pieces (or a filemap_t scanned a window at
+    // a time), a match across a boundary is reported by the chunk it
+    // completes in.
+    class matcher_t {
+    public:
+        struct match_t {
+            std::size_t offset;     // from the start of the text (or stream)
+            std::size_t pattern;
+        };
+    private:
+        std::array<std::uint8_t, 256> classes{};
+        std::size_t columns = 1;
+        std::vector<std::uint32_t> table;
+        // Patterns ending at state s are outputs[ends[s],ends[s+1])
+        std::vector<std::uint32_t> ends;
+        std::vector<std::uint32_t> outputs;
+        std::vector<std::size_t> lengths;
+        std::string single;     // the pattern, when there is just one
+        
+        auto build(const std::vector<std::string_view> &patterns) -> void {
+            for (const auto &pattern : patterns) {
+                if (pattern.empty()) {
+                    throw std::runtime_error("Search patterns can not be empty");
+                }
+                for (auto ch : pattern) {
+                    auto &column = classes[static_cast<unsigned char>(ch)];
+                    if (column == 0) {
+                        if (columns == 256) {
+                            throw std::runtime_error("Search patterns use too many byte values");
+                        }
+                        column = static_cast<std::uint8_t>(columns++);
+                    }
+                }
+                lengths.push_back(pattern.size());
+            }
+            if (patterns.size() == 1) {
+                single = std::string(patterns[0]);
+            }
+            // The trie, missing edges are none
+            constexpr auto none = std::numeric_limits<std::uint32_t>::max();
+            auto next = std::vector<std::uint32_t>(columns, none);
+            auto found = std::vector<std::vector<std::uint32_t>>(1);
+            for (std::size_t id = 0; id < patterns.size(); ++id) {
+                auto state = std::size_t(0);
+                for (auto ch : patterns[id]) {
+                    auto &edge = next[state * columns + classes[static_cast<unsigned char>(ch)]];
+                    if (edge == none) {
+                        if (found.size() * columns >= (std::size_t(1) << 31)) {
+                            throw std::runtime_error("Search patterns are too large");
+                        }
+                        edge = static_cast<std::uint32_t>(found.size());
+                        found.emplace_back();
+                        next.resize(next.size() + columns, none);
+                    }
+                    state = next[state * columns + classes[static_cast<unsigned char>(ch)]];
+                }
+                found[state].push_back(static_cast<std::uint32_t>(id));
+            }
+            // Breadth first, so a state's fallback (a shorter suffix) is
+            // complete before it: missing edges take the fallback's edge,
+            // and a state also ends whatever its fallback ends
+            auto fallback = std::vector<std::uint32_t>(found.size(), 0);
+            auto order = std::vector<std::uint32_t>{0};
+            for (std::size_t at = 0; at < order.size(); ++at) {
+                auto state = order[at];
+                for (std::size_t column = 0; column < columns; ++column) {
+                    auto &edge = next[state * columns + column];
+                    if (edge == none) {
+                        edge = (state == 0) ? 0 : next[fallback[state] * columns + column];
+                        continue;
+                    }
+                    fallback[edge] = (state == 0) ? 0 : next[fallback[state] * columns + column];
+                    const auto &inherited = found[fallback[edge]];
+                    found[edge].insert(found[edge].end(), inherited.begin(), inherited.end());
+                    order.push_back(edge);
                 }
-                loc = value.find(sep, current);
             }
-            if (current < value.size()) {
-                rvalue.push_back(trim(value.substr(current)));
+            table.resize(next.size());
+            for (std::size_t index = 0; index < next.size(); ++index) {
+                auto target = next[index];
+                table[index] = ((target * static_cast<std::uint32_t>(columns)) << 1) | (found[target].empty() ? 0 : 1);
+            }
+            ends.push_back(0);
+            for (const auto &ids : found) {
+                outputs.insert(outputs.end(), ids.begin(), ids.end());
+                ends.push_back(static_cast<std::uint32_t>(outputs.size()));
             }
         }
-        else {
-            rvalue.push_back(trim(value));
+        //=========================================================
+        // Runs data through from entry (a table entry), base being the
+        // offset of data in the text, false if the callback stopped it
+        template <typename Callback>
+        auto run(std::uint32_t &entry, const char *data, std::size_t length, std::size_t base, Callback &callback) const -> bool {
+            auto current = entry;
+            for (std::size_t index = 0; index < length; ++index) {
+                current = table[(current >> 1) + classes[static_cast<unsigned char>(data[index])]];
+                if ((current & 1) != 0) {
+                    auto state = (current >> 1) / columns;
+                    for (auto at = ends[state]; at < ends[state + 1]; ++at) {
+                        auto match = match_t{base + index + 1 - lengths[outputs[at]], outputs[at]};
+                        if (!report(callback, match)) {
+                            entry = current;
+                            return false;
+                        }
+                    }
+                }
+            }
+            entry = current;
+            return true;
         }
-        return rvalue;
-    }
+        //=========================================================
+        // Callbacks may return void, or bool with false to stop
+        template <typename Callback>
+        static auto report(Callback &callback, const match_t &match) -> bool {
+            if constexpr (std::is_same_v<decltype(callback(match)), bool>) {
+                return callback(match);
+            }
+            else {
+                callback(match);
+                return true;
+            }
+        }
+    public:
+        //=========================================================
+        class stream_t {
+            const matcher_t *matcher;
+            std::uint32_t entry = 0;
+            std::size_t offset = 0;
+        public:
+            explicit stream_t(const matcher_t &matcher) : matcher(&matcher) {}
+            // Scans the next chunk, false if the callback stopped it (the
+            // rest of the chunk is then skipped)
+            template <typename Callback>
+            auto feed(std::string_view chunk, Callback &&callback) -> bool {
+                auto base = offset;
+                offset += chunk.size();
+                return matcher->run(entry, chunk.data(), chunk.size(), base, callback);
+            }
+            template <typename Callback>
+            auto feed(const std::uint8_t *data, std::size_t length, Callback &&callback) -> bool {
+                return feed(std::string_view(reinterpret_cast<const char *>(data), length), callback);
+            }
+            // Bytes fed so far
+            auto consumed() const -> std::size_t { return offset; }
+            auto reset() -> void {
+                entry = 0;
+                offset = 0;
+            }
+        };
+        
+        matcher_t(std::initializer_list<std::string_view> patterns) {
+            build(std::vector<std::string_view>(patterns));
+        }
+        explicit matcher_t(const std::vector<std::string_view> &patterns) {
+            build(patterns);
+        }
+        explicit matcher_t(const std::vector<std::string> &patterns) {
+            build(std::vector<std::string_view>(patterns.begin(), patterns.end()));
+        }
+        
+        //=========================================================
+        // Calls callback(match_t) for every match in text, false if the
+        // callback stopped it
+        template <typename Callback>
+        auto scan(std::string_view text, Callback &&callback) const -> bool {
+            if (!single.empty()) {
+                for (auto loc = strutil::find(text, single); loc != std::string_view::npos; loc = strutil::find(text, single, loc + 1)) {
+                    if (!report(callback, match_t{loc, 0})) {
+                        return false;
+                    }
+                }
+                return true;
+            }
+            auto entry = std::uint32_t(0);
+            return run(entry, text.data(), text.size(), 0, callback);
+        }
+        //=========================================================
+        auto find_all(std::string_view text) const -> std::vector<match_t> {
+            auto rvalue = std::vector<match_t>();
+            scan(text, [&rvalue](const match_t &match) { rvalue.push_back(match); });
+            return rvalue;
+        }
+        //=========================================================
+        // The first match to end in text, pattern is npos if there is none
+        auto find_first(std::string_view text) const -> match_t {
+            auto rvalue = match_t{std::string_view::npos, std::string_view::npos};
+            scan(text, [&rvalue](const match_t &match) {
+                rvalue = match;
+                return false;
+            });
+            return rvalue;
+        }
+        auto stream() const -> stream_t { return stream_t(*this); }
+        auto size() const -> std::size_t { return lengths.size(); }
+        auto length(std::size_t pattern) const -> std::size_t { return lengths.at(pattern); }
+    };
     
     //=========================================================
     // Time/String conversions
@@ -232,94 +953,728 @@ namespace strutil {
     }
     
     //==========================================================
-    // Number/string conversions
-    //==========================================================
-    
-    //==========================================================
-    // Radix that are supported
-    enum class radix_t { dec = 10, oct = 8, hex = 16, bin = 2 };
-    
-    //==========================================================
-    // The maximum characters in a string number for conversion sake
-    inline constexpr auto max_characters_in_number = 12;
-    
-    //==========================================================
-    // Convert a bool to a string
-    // the true_value/false_value are returned based on the bool
-    inline auto ntos(bool value, const std::string &true_value = "true", const std::string &false_value = "false") -> std::string {
-        return (value ? true_value : false_value);
-    }
-    
+    // Type safe formatting with {} fields, parsed when the formatter is
+    // made, so a constexpr formatter is parsed (and checked) at compile time:
+    //     static constexpr auto line = strutil::formatter_t("{} = {} ({:#010x})");
+    //     char text[64];
+    //     auto length = line.format_to(text, sizeof(text), "value", 42, 0xBEEF);
+    // A field is {} or {:spec}, spec being [[fill]align][#][0][width][.precision][type]
+    //     align     < left, > right, ^ centre (numbers default right, text left)
+    //     #         radix prefix (0x, 0o, 0b) as ntos() adds it
+    //     0         pad numbers with zeros after the sign and prefix
+    //     type      d x X o b for integers, f e g for floating point
+    // Fields take the arguments in order; {{ and }} are literal braces.
+    // Integers and floating point go through to_chars, bools write true/false,
+    // anything convertible to std::string_view is copied.
+    // The members check the arguments (their count, and that type letters
+    // suit them) when called; through the free format<line>() and
+    // format_to<line>() below they are checked at compile time.
     //==========================================================
-    // Convert a number to a string, with options on radix,prefix,size,pad
-    // Radix indicates the radix the string will represent
-    // prefix indicates if the "radix" indicator will be present at the front of the
-    // string size is the minimum size the string must be (if the number is not
-    // large enough it will use the "pad" character prepended to the number
-    template <typename T>
-    auto ntos(T value, radix_t radix = radix_t::dec, bool prefix = false,  int size = 0, char pad = '0') -> std::string {
-        if constexpr (std::is_integral_v<T> && !std::is_same_v<T, bool>) {
-            // first, thing we need to convert the value to a string
-            std::array<char, max_characters_in_number> str;
-            
-            if (auto [pc, ec] = std::to_chars(str.data(), str.data() + str.size(),
-                                              value, static_cast<int>(radix));
-                ec == std::errc()) {
-                // How many characters did this number take
-                auto numchars = static_cast<int>(std::distance(str.data(), pc));
-                // what is larger, that is the size of our string
-                auto sizeofstring = std::max(numchars, size);
-                // where do we start adding the number into our string ?
-                auto index = sizeofstring - numchars;
-                if (prefix) {
-                    // We have a prefix, so we add two characters to the beginning
-                    sizeofstring += 2;
-                    index += 2;
+    template <std::size_t N>
+    class formatter_t {
+    public:
+        struct segment_t {
+            std::size_t offset = 0;     // literal text, into the format string
+            std::size_t length = 0;
+            bool field = false;
+            char fill = ' ';
+            char align = 0;             // 0 when not given
+            bool alternate = false;
+            bool zero = false;
+            int width = 0;
+            int precision = -1;
+            char type = 0;
+        };
+    private:
+        const char *text;
+        std::array<segment_t, N> segments{};
+        std::size_t count = 0;
+        std::size_t fields = 0;
+        
+        //==========================================================
+        // Writes what fits, counting all of it
+        struct writer_t {
+            char *data;
+            std::size_t size;
+            std::size_t used;
+            auto append(const char *value, std::size_t length) -> void {
+                if ((length != 0) && (used < size)) {
+                    std::memcpy(data + used, value, std::min(length, size - used));
+                }
+                used += length;
+            }
+            auto repeat(char value, std::size_t length) -> void {
+                if (used < size) {
+                    std::memset(data + used, value, std::min(length, size - used));
+                }
+                used += length;
+            }
+        };
+        
+        //==========================================================
+        static constexpr auto is_digit(char ch) -> bool {
+            return (ch >= '0') && (ch <= '9');
+        }
+        static constexpr auto is_align(char ch) -> bool {
+            return (ch == '<') || (ch == '>') || (ch == '^');
+        }
+        constexpr auto add_literal(std::size_t offset, std::size_t length) -> void {
+            if (length == 0) {
+                return;
+            }
+            // Joins with the literal before, so {{ splits as little as possible
+            if ((count > 0) && !segments[count - 1].field && (segments[count - 1].offset + segments[count - 1].length == offset)) {
+                segments[count - 1].length += length;
+                return;
+            }
+            segments[count].offset = offset;
+            segments[count].length = length;
+            ++count;
+        }
+        //==========================================================
+        // Parses the spec in [start, end) of a field
+        constexpr auto parse_spec(std::size_t start, std::size_t end) -> segment_t {
+            auto spec = segment_t{};
+            spec.field = true;
+            auto index = start;
+            if ((end - index >= 2) && is_align(text[index + 1])) {
+                spec.fill = text[index];
+                spec.align = text[index + 1];
+                index += 2;
+            }
+            else if ((index < end) && is_align(text[index])) {
+                spec.align = text[index++];
+            }
+            if ((index < end) && (text[index] == '#')) {
+                spec.alternate = true;
+                ++index;
+            }
+            if ((index < end) && (text[index] == '0')) {
+                spec.zero = true;
+                ++index;
+            }
+            while ((index < end) && is_digit(text[index])) {
+                spec.width = spec.width * 10 + (text[index++] - '0');
+                if (spec.width > 1024) {
+                    throw std::runtime_error("Format field width is too large");
+                }
+            }
+            if ((index < end) && (text[index] == '.')) {
+                ++index;
+                if ((index == end) || !is_digit(text[index])) {
+                    throw std::runtime_error("Format field precision is missing");
                 }
-                auto rvalue = std::string(sizeofstring, pad);
-                // copy the value into the string
-                std::copy(str.data(), pc, rvalue.begin() + index);
-                // do we need our prefix?
-                if (prefix) {
-                    switch (static_cast<int>(radix)) {
-                        case static_cast<int>(radix_t::dec):
-                            // We dont add anything for decimal!
-                            break;
-                        case static_cast<int>(radix_t::hex):
-                            rvalue[0] = '0';
-                            rvalue[1] = 'x';
-                            break;
-                        case static_cast<int>(radix_t::oct):
-                            rvalue[0] = '0';
-                            rvalue[1] = 'o';
-                            break;
-                        case static_cast<int>(radix_t::bin):
-                            rvalue[0] = '0';
-                            rvalue[1] = 'b';
-                            break;
-                            
-                        default:
-                            break;
+                spec.precision = 0;
+                while ((index < end) && is_digit(text[index])) {
+                    spec.precision = spec.precision * 10 + (text[index++] - '0');
+                    if (spec.precision > 100) {
+                        throw std::runtime_error("Format field precision is too large");
                     }
                 }
-                return rvalue;
-                
-            } else {
-                // The conversion was not successful, so we return an empty string
-                return std::string();
             }
+            if (index < end) {
+                switch (text[index]) {
+                    case 'd': case 'x': case 'X': case 'o': case 'b':
+                    case 'f': case 'e': case 'g':
+                        spec.type = text[index++];
+                        break;
+                    default:
+                        break;
+                }
+            }
+            if (index != end) {
+                throw std::runtime_error("Invalid format field specification");
+            }
+            return spec;
         }
-    }
-    
-    //==========================================================
-    // Convert a string to a number
-    template <typename T>
-    typename std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>, T>
-    ston(const std::string &str_value, radix_t radix = radix_t::dec) {
-        auto value = T{0};
-        if (!str_value.empty()) {
-            if (str_value.size() < 2) {
-                std::from_chars(str_value.data(),
+        
+        //==========================================================
+        static auto pad(writer_t &writer, const segment_t &spec, const char *prefix, std::size_t prefix_length, const char *body, std::size_t body_length, bool number) -> void {
+            auto length = prefix_length + body_length;
+            auto padding = (static_cast<std::size_t>(spec.width) > length) ? static_cast<std::size_t>(spec.width) - length : std::size_t(0);
+            if (number && spec.zero && (spec.align == 0)) {
+                writer.append(prefix, prefix_length);
+                writer.repeat('0', padding);
+                writer.append(body, body_length);
+                return;
+            }
+            auto align = (spec.align != 0) ? spec.align : (number ? '>' : '<');
+            auto before = (align == '>') ? padding : ((align == '^') ? padding / 2 : 0);
+            writer.repeat(spec.fill, before);
+            writer.append(prefix, prefix_length);
+            writer.append(body, body_length);
+            writer.repeat(spec.fill, padding - before);
+        }
+        //==========================================================
+        // Whether a field's type letter suits an argument of type T
+        // (integers take d x X o b, floating point f e g, others none)
+        template <typename T>
+        static constexpr auto fits(char type) -> bool {
+            if (type == 0) {
+                return true;
+            }
+            if constexpr (std::is_same_v<T, bool> || std::is_same_v<T, char>) {
+                return false;
+            }
+            else if constexpr (std::is_integral_v<T>) {
+                return (type == 'd') || (type == 'x') || (type == 'X') || (type == 'o') || (type == 'b');
+            }
+            else if constexpr (std::is_floating_point_v<T>) {
+                return (type == 'f') || (type == 'e') || (type == 'g');
+            }
+            else {
+                return false;
+            }
+        }
+        //==========================================================
+        template <typename T>
+        static auto put(writer_t &writer, const segment_t &spec, const T &value) -> void {
+            if (!fits<T>(spec.type)) {
+                throw std::runtime_error(std::string("Format field type does not fit its argument: ") + spec.type);
+            }
+            if constexpr (std::is_same_v<T, bool>) {
+                auto word = value ? std::string_view("true") : std::string_view("false");
+                pad(writer, spec, nullptr, 0, word.data(), word.size(), false);
+            }
+            else if constexpr (std::is_same_v<T, char>) {
+                pad(writer, spec, nullptr, 0, &value, 1, false);
+            }
+            else if constexpr (std::is_integral_v<T>) {
+                auto radix = 10;
+                auto prefix = std::string_view();
+                switch (spec.type) {
+                    case 'x': case 'X':
+                        radix = 16;
+                        prefix = "0x";
+                        break;
+                    case 'o':
+                        radix = 8;
+                        prefix = "0o";
+                        break;
+                    case 'b':
+                        radix = 2;
+                        prefix = "0b";
+                        break;
+                    default:
+                        break;
+                }
+                // Room for 64 binary digits and a sign
+                std::array<char, 72> digits;
+                auto [end, ec] = std::to_chars(digits.data() + 1, digits.data() + digits.size(), value, radix);
+                static_cast<void>(ec);
+                auto body = digits.data() + 1;
+                // The sign goes before the prefix
+                std::array<char, 3> lead{};
+                auto lead_length = std::size_t(0);
+                if (*body == '-') {
+                    lead[lead_length++] = '-';
+                    ++body;
+                }
+                if (spec.alternate && !prefix.empty()) {
+                    lead[lead_length++] = prefix[0];
+                    lead[lead_length++] = prefix[1];
+                }
+                auto length = static_cast<std::size_t>(end - body);
+                if (spec.type == 'X') {
+                    detail::convert_case(body, body, length, 'a');
+                }
+                pad(writer, spec, lead.data(), lead_length, body, length, true);
+            }
+            else if constexpr (std::is_floating_point_v<T>) {
+                auto format = std::chars_format::general;
+                if (spec.type == 'f') {
+                    format = std::chars_format::fixed;
+                }
+                else if (spec.type == 'e') {
+                    format = std::chars_format::scientific;
+                }
+                auto convert = [&](char *first, char *last) {
+                    if (spec.precision >= 0) {
+                        return std::to_chars(first, last, value, format, spec.precision);
+                    }
+                    if (spec.type != 0) {
+                        return std::to_chars(first, last, value, format);
+                    }
+                    // Shortest text that reads back as the same value
+                    return std::to_chars(first, last, value);
+                };
+                // Enough for the widest fixed double at the largest precision,
+                // a wider type (a large long double in fixed) goes to the heap
+                std::array<char, 512> local;
+                auto large = std::vector<char>();
+                auto digits = local.data();
+                auto result = convert(local.data(), local.data() + local.size());
+                if (result.ec == std::errc::value_too_large) {
+                    large.resize(static_cast<std::size_t>(std::numeric_limits<T>::max_exponent10) + static_cast<std::size_t>(std::max(spec.precision, 0)) + 64);
+                    digits = large.data();
+                    result = convert(large.data(), large.data() + large.size());
+                }
+                if (result.ec != std::errc()) {
+                    throw std::runtime_error("Unable to format floating point value");
+                }
+                auto body = digits;
+                auto lead_length = std::size_t(0);
+                if (*body == '-') {
+                    lead_length = 1;
+                    ++body;
+                }
+                pad(writer, spec, "-", lead_length, body, static_cast<std::size_t>(result.ptr - body), true);
+            }
+            else if constexpr (std::is_convertible_v<const T &, std::string_view>) {
+                auto view = std::string_view(value);
+                pad(writer, spec, nullptr, 0, view.data(), view.size(), false);
+            }
+            else {
+                static_assert(std::is_convertible_v<const T &, std::string_view>, "formatter_t can not format this type");
+            }
+        }
+    public:
+        //==========================================================
+        constexpr formatter_t(const char (&format)[N]) : text(format) {
+            auto literal = std::size_t(0);
+            auto index = std::size_t(0);
+            auto length = N - 1;
+            while (index < length) {
+                auto ch = text[index];
+                if ((ch == '{') || (ch == '}')) {
+                    add_literal(literal, index - literal);
+                    if ((index + 1 < length) && (text[index + 1] == ch)) {
+                        // Doubled brace, keep one
+                        literal = index + 1;
+                        index += 2;
+                        continue;
+                    }
+                    if (ch == '}') {
+                        throw std::runtime_error("Unmatched } in format string");
+                    }
+                    auto close = index + 1;
+                    while ((close < length) && (text[close] != '}')) {
+                        ++close;
+                    }
+                    if (close == length) {
+                        throw std::runtime_error("Unmatched { in format string");
+                    }
+                    auto start = index + 1;
+                    if (start < close) {
+                        if (text[start] != ':') {
+                            throw std::runtime_error("Format fields take no index or name");
+                        }
+                        ++start;
+                    }
+                    segments[count++] = parse_spec(start, close);
+                    ++fields;
+                    index = close + 1;
+                    literal = index;
+                    continue;
+                }
+                ++index;
+            }
+            add_literal(literal, length - literal);
+        }
+        //==========================================================
+        constexpr auto field_count() const -> std::size_t {
+            return fields;
+        }
+        //==========================================================
+        // Whether the fields take these arguments: as many, and each
+        // field's type letter suits its argument
+        template <typename... Args>
+        constexpr auto accepts() const -> bool {
+            if (sizeof...(Args) != fields) {
+                return false;
+            }
+            auto index = std::size_t(0);
+            auto field = [&]() -> const segment_t & {
+                while (!segments[index].field) {
+                    ++index;
+                }
+                return segments[index++];
+            };
+            return (fits<Args>(field().type) && ...);
+        }
+        //==========================================================
+        // Writes up to size characters (no terminating 0), returns the full
+        // length, so a result over size means the output was cut short
+        template <typename... Args>
+        auto format_to(char *output, std::size_t size, const Args &...args) const -> std::size_t {
+            if (sizeof...(Args) != fields) {
+                throw std::runtime_error("Format string has " + std::to_string(fields) + " fields, given " + std::to_string(sizeof...(Args)) + " arguments");
+            }
+            auto writer = writer_t{output, size, 0};
+            auto index = std::size_t(0);
+            auto next = [&](const auto &value) {
+                while (!segments[index].field) {
+                    writer.append(text + segments[index].offset, segments[index].length);
+                    ++index;
+                }
+                put(writer, segments[index], value);
+                ++index;
+            };
+            (next(args), ...);
+            for (; index < count; ++index) {
+                writer.append(text + segments[index].offset, segments[index].length);
+            }
+            return writer.used;
+        }
+        //==========================================================
+        template <std::size_t M, typename... Args>
+        auto format_to(std::array<char, M> &output, const Args &...args) const -> std::size_t {
+            return format_to(output.data(), M, args...);
+        }
+        //==========================================================
+        // Appends to a util::buffer_t (or anything with its write<std::uint8_t>(std::uint8_t*,
+        // amount)), through the stack unless the text is long
+        template <typename Buffer, typename... Args>
+        auto write(Buffer &buffer, const Args &...args) const -> Buffer & {
+            std::array<char, 256> local;
+            auto length = format_to(local.data(), local.size(), args...);
+            if (length <= local.size()) {
+                buffer.template write<std::uint8_t>(reinterpret_cast<std::uint8_t *>(local.data()), length);
+                return buffer;
+            }
+            auto large = std::vector<char>(length);
+            format_to(large.data(), large.size(), args...);
+            buffer.template write<std::uint8_t>(reinterpret_cast<std::uint8_t *>(large.data()), length);
+            return buffer;
+        }
+        //==========================================================
+        template <typename... Args>
+        auto format(const Args &...args) const -> std::string {
+            std::array<char, 256> local;
+            auto length = format_to(local.data(), local.size(), args...);
+            if (length <= local.size()) {
+                return std::string(local.data(), length);
+            }
+            auto rvalue = std::string(length, ' ');
+            format_to(rvalue.data(), rvalue.size(), args...);
+            return rvalue;
+        }
+    };
+    
+    //==========================================================
+    // A formatter with static storage (a static constexpr, at any scope)
+    // checked against the arguments at compile time:
+    //     static constexpr auto line = strutil::formatter_t("{} = {}");
+    //     auto text = strutil::format<line>("value", 42);
+    template <const auto &Formatter, typename... Args>
+    auto format(const Args &...args) -> std::string {
+        static_assert(Formatter.field_count() == sizeof...(Args), "Format string fields and arguments differ in number");
+        static_assert(Formatter.template accepts<Args...>(), "Format field type does not fit its argument");
+        return Formatter.format(args...);
+    }
+    //==========================================================
+    template <const auto &Formatter, typename... Args>
+    auto format_to(char *output, std::size_t size, const Args &...args) -> std::size_t {
+        static_assert(Formatter.field_count() == sizeof...(Args), "Format string fields and arguments differ in number");
+        static_assert(Formatter.template accepts<Args...>(), "Format field type does not fit its argument");
+        return Formatter.format_to(output, size, args...);
+    }
+    //==========================================================
+    template <const auto &Formatter, typename Buffer, typename... Args>
+    auto write(Buffer &buffer, const Args &...args) -> Buffer & {
+        static_assert(Formatter.field_count() == sizeof...(Args), "Format string fields and arguments differ in number");
+        static_assert(Formatter.template accepts<Args...>(), "Format field type does not fit its argument");
+        return Formatter.write(buffer, args...);
+    }
+    
+    //==========================================================
+    // Number/string conversions
+    //==========================================================
+    
+    //==========================================================
+    // Radix that are supported
+    enum class radix_t { dec = 10, oct = 8, hex = 16, bin = 2 };
+    
+    //==========================================================
+    // The maximum characters in a string number for conversion sake
+    // (a 64 bit value in binary, and its sign, the prefix aside)
+    inline constexpr auto max_characters_in_number = 65;
+    
+    namespace detail {
+        //==========================================================
+        inline constexpr std::uint64_t powers_of_ten[] = {
+            1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL,
+            100000000ULL, 1000000000ULL, 10000000000ULL, 100000000000ULL, 1000000000000ULL,
+            10000000000000ULL, 100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL,
+            100000000000000000ULL, 1000000000000000000ULL, 10000000000000000000ULL};
+        //==========================================================
+        // "00" to "99", two characters per entry
+        inline constexpr auto make_digit_pairs() -> std::array<char, 200> {
+            auto table = std::array<char, 200>{};
+            for (auto value = 0; value < 100; ++value) {
+                table[2 * value] = static_cast<char>('0' + value / 10);
+                table[2 * value + 1] = static_cast<char>('0' + value % 10);
+            }
+            return table;
+        }
+        inline constexpr auto digit_pairs = make_digit_pairs();
+        //==========================================================
+        inline auto bit_length(std::uint64_t value) -> int {
+#if defined(_MSC_VER)
+            unsigned long index;
+            _BitScanReverse64(&index, value | 1);
+            return static_cast<int>(index) + 1;
+#else
+            return 64 - __builtin_clzll(value | 1);
+#endif
+        }
+        //==========================================================
+        // Digits of value in the radix, from its bit length (log10 2 is
+        // about 1233/4096) with one compare to correct it for decimal
+        inline auto count_digits(std::uint64_t value, radix_t radix) -> std::size_t {
+            auto bits = bit_length(value);
+            switch (radix) {
+                case radix_t::hex:
+                    return static_cast<std::size_t>((bits + 3) / 4);
+                case radix_t::oct:
+                    return static_cast<std::size_t>((bits + 2) / 3);
+                case radix_t::bin:
+                    return static_cast<std::size_t>(bits);
+                default: {
+                    auto estimate = static_cast<std::size_t>((bits * 1233) >> 12);
+                    // (0 counts as one digit, like 1)
+                    return estimate + 1 - (((value | 1) < powers_of_ten[estimate]) ? 1 : 0);
+                }
+            }
+        }
+        //==========================================================
+        // Writes the digits of value to end back to end - count
+        inline auto write_digits(char *end, std::uint64_t value, std::size_t count, radix_t radix) -> void {
+            if (radix == radix_t::dec) {
+                while (value >= 100) {
+                    auto pair = static_cast<std::size_t>(value % 100) * 2;
+                    value /= 100;
+                    *--end = digit_pairs[pair + 1];
+                    *--end = digit_pairs[pair];
+                }
+                if (value >= 10) {
+                    *--end = digit_pairs[value * 2 + 1];
+                    *--end = digit_pairs[value * 2];
+                }
+                else {
+                    *--end = static_cast<char>('0' + value);
+                }
+                return;
+            }
+            auto bits = (radix == radix_t::hex) ? 4 : ((radix == radix_t::oct) ? 3 : 1);
+            auto mask = (std::uint64_t(1) << bits) - 1;
+            for (std::size_t i = 0; i < count; ++i) {
+                *--end = "0123456789abcdef"[value & mask];
+                value >>= bits;
+            }
+        }
+        //==========================================================
+        // Magnitude and sign of an integer, the minimum included
+        template <typename T>
+        auto magnitude(T value, bool &negative) -> std::uint64_t {
+            negative = false;
+            if constexpr (std::is_signed_v<T>) {
+                if (value < 0) {
+                    negative = true;
+                    return std::uint64_t(0) - static_cast<std::uint64_t>(static_cast<std::int64_t>(value));
+                }
+            }
+            return static_cast<std::uint64_t>(value);
+        }
+        //==========================================================
+        // Room for amount bytes at a util::buffer_t's position (growing it
+        // when it is expandable), the caller moves the position on
+        template <typename Buffer>
+        auto writable(Buffer &buffer, std::size_t amount) -> char * {
+            if (buffer.remaining() < amount) {
+                if (!buffer.expandaable()) {
+                    throw std::out_of_range("Write would exceed buffer");
+                }
+                buffer.resize(buffer.at() + amount);
+            }
+            if (buffer.raw() == nullptr) {
+                throw std::runtime_error("Buffer is not writeable");
+            }
+            return reinterpret_cast<char *>(buffer.raw()) + buffer.at();
+        }
+        //==========================================================
+        inline auto prefix_of(radix_t radix) -> const char * {
+            switch (radix) {
+                case radix_t::hex:
+                    return "0x";
+                case radix_t::oct:
+                    return "0o";
+                case radix_t::bin:
+                    return "0b";
+                default:
+                    return "";
+            }
+        }
+    } // namespace detail
+    
+    //==========================================================
+    // Characters ntos() writes for value with these options, known
+    // before writing anything
+    template <typename T>
+    auto ntos_size(T value, radix_t radix = radix_t::dec, bool prefix = false, int size = 0) -> std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>, std::size_t> {
+        auto negative = false;
+        auto digits = detail::count_digits(detail::magnitude(value, negative), radix) + (negative ? 1 : 0);
+        return std::max(digits, static_cast<std::size_t>(std::max(size, 0))) + ((prefix && (radix != radix_t::dec)) ? 2 : 0);
+    }
+    //==========================================================
+    // Writes an integer into output, as ntos() would make it (no
+    // terminating 0), returns the length written, 0 if it does not fit
+    template <typename T>
+    auto ntos(char *output, std::size_t length, T value, radix_t radix = radix_t::dec, bool prefix = false, int size = 0, char pad = '0') -> std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>, std::size_t> {
+        auto negative = false;
+        auto number = detail::magnitude(value, negative);
+        auto digits = detail::count_digits(number, radix);
+        auto numchars = digits + (negative ? 1 : 0);
+        auto padding = (static_cast<std::size_t>(std::max(size, 0)) > numchars) ? static_cast<std::size_t>(size) - numchars : std::size_t(0);
+        auto lead = (prefix && (radix != radix_t::dec)) ? std::size_t(2) : std::size_t(0);
+        auto total = lead + padding + numchars;
+        if (total > length) {
+            return 0;
+        }
+        std::memcpy(output, detail::prefix_of(radix), lead);
+        std::memset(output + lead, pad, padding);
+        if (negative) {
+            output[lead + padding] = '-';
+        }
+        detail::write_digits(output + total, number, digits, radix);
+        return total;
+    }
+    //==========================================================
+    // Writes count integers, sep between each, into output, returns
+    // the length written, 0 if they do not all fit
+    template <typename T>
+    auto ntos(char *output, std::size_t length, const T *values, std::size_t count, char sep = ',', radix_t radix = radix_t::dec, bool prefix = false, int size = 0, char pad = '0') -> std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>, std::size_t> {
+        auto used = std::size_t(0);
+        for (std::size_t i = 0; i < count; ++i) {
+            if (i != 0) {
+                if (used == length) {
+                    return 0;
+                }
+                output[used++] = sep;
+            }
+            auto written = ntos(output + used, length - used, values[i], radix, prefix, size, pad);
+            if (written == 0) {
+                return 0;
+            }
+            used += written;
+        }
+        return used;
+    }
+    //==========================================================
+    // The same into a util::buffer_t at its position (growing it when it
+    // is expandable), sizing the whole run first so the digits go straight
+    // into the buffer's memory
+    template <typename Buffer, typename T>
+    auto ntos(Buffer &buffer, const T *values, std::size_t count, char sep = ',', radix_t radix = radix_t::dec, bool prefix = false, int size = 0, char pad = '0') -> std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>, Buffer &> {
+        auto total = (count == 0) ? std::size_t(0) : count - 1;
+        for (std::size_t i = 0; i < count; ++i) {
+            total += ntos_size(values[i], radix, prefix, size);
+        }
+        ntos(detail::writable(buffer, total), total, values, count, sep, radix, prefix, size, pad);
+        buffer.at(buffer.at() + total);
+        return buffer;
+    }
+    
+    //==========================================================
+    // Convert a bool to a string
+    // the true_value/false_value are returned based on the bool
+    inline auto ntos(bool value, const std::string &true_value = "true", const std::string &false_value = "false") -> std::string {
+        return (value ? true_value : false_value);
+    }
+    
+    //==========================================================
+    // Convert a number to a string, with options on radix,prefix,size,pad
+    // Radix indicates the radix the string will represent
+    // prefix indicates if the "radix" indicator will be present at the front of the
+    // string size is the minimum size the string must be (if the number is not
+    // large enough it will use the "pad" character prepended to the number
+    template <typename T>
+    auto ntos(T value, radix_t radix = radix_t::dec, bool prefix = false,  int size = 0, char pad = '0') -> std::string {
+        if constexpr (std::is_integral_v<T> && !std::is_same_v<T, bool>) {
+            auto rvalue = std::string(ntos_size(value, radix, prefix, size), pad);
+            ntos(rvalue.data(), rvalue.size(), value, radix, prefix, size, pad);
+            return rvalue;
+        }
+        else if constexpr (std::is_floating_point_v<T>) {
+            // Shortest text that reads back as the same value, the radix
+            // and prefix do not apply
+            std::array<char, 64> str;
+            auto [pc, ec] = std::to_chars(str.data(), str.data() + str.size(), value);
+            if (ec != std::errc()) {
+                return std::string();
+            }
+            auto numchars = static_cast<int>(std::distance(str.data(), pc));
+            auto rvalue = std::string(static_cast<std::size_t>(std::max(numchars, size)), pad);
+            std::copy(str.data(), pc, rvalue.end() - numchars);
+            return rvalue;
+        }
+    }
+    
+    //==========================================================
+    // How floating point numbers are written
+    //     shortest    fewest digits that read back as the same value
+    //     fixed       [-]ddd.ddd
+    //     scientific  [-]d.ddde[+-]dd
+    //     general     fixed or scientific, whichever is shorter (like %g)
+    enum class floatformat_t { shortest, fixed, scientific, general };
+    
+    //==========================================================
+    // Writes a floating point number into output (no terminating 0),
+    // returns the length written, 0 if it does not fit. precision is the
+    // digits after the point (significant digits for general), -1 for the
+    // shortest digits in that format; shortest ignores it
+    template <typename T>
+    auto ntos(char *output, std::size_t size, T value, floatformat_t format = floatformat_t::shortest, int precision = -1) -> std::enable_if_t<std::is_floating_point_v<T>, std::size_t> {
+        auto result = std::to_chars_result{};
+        auto chars = std::chars_format::general;
+        switch (format) {
+            case floatformat_t::fixed:
+                chars = std::chars_format::fixed;
+                break;
+            case floatformat_t::scientific:
+                chars = std::chars_format::scientific;
+                break;
+            default:
+                break;
+        }
+        if (format == floatformat_t::shortest) {
+            result = std::to_chars(output, output + size, value);
+        }
+        else if (precision < 0) {
+            result = std::to_chars(output, output + size, value, chars);
+        }
+        else {
+            result = std::to_chars(output, output + size, value, chars, precision);
+        }
+        if (result.ec != std::errc()) {
+            return 0;
+        }
+        return static_cast<std::size_t>(result.ptr - output);
+    }
+    //==========================================================
+    // Convert a floating point number to a string, in the given format
+    template <typename T>
+    auto ntos(T value, floatformat_t format, int precision = -1) -> std::enable_if_t<std::is_floating_point_v<T>, std::string> {
+        std::array<char, 128> str;
+        auto length = ntos(str.data(), str.size(), value, format, precision);
+        if (length != 0) {
+            return std::string(str.data(), length);
+        }
+        // Large fixed values or high precision
+        auto rvalue = std::string(static_cast<std::size_t>(std::numeric_limits<T>::max_exponent10 + 32 + std::max(precision, 0)), ' ');
+        rvalue.resize(ntos(rvalue.data(), rvalue.size(), value, format, precision));
+        return rvalue;
+    }
+    
+    //==========================================================
+    // Convert a string to a number
+    template <typename T>
+    typename std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>, T>
+    ston(const std::string &str_value, radix_t radix = radix_t::dec) {
+        auto value = T{0};
+        if (!str_value.empty()) {
+            if (str_value.size() < 2) {
+                std::from_chars(str_value.data(),
                                 str_value.data() + str_value.size(), value,
                                 static_cast<int>(radix));
                 
@@ -366,6 +1721,25 @@ namespace strutil {
         return value;
     }
     
+    //==========================================================
+    // Convert a string to a floating point number (fixed or scientific,
+    // correctly rounded), throwing on bad text like the integer ston()
+    template <typename T>
+    typename std::enable_if_t<std::is_floating_point_v<T>, T>
+    ston(const std::string &str_value) {
+        auto value = T{0};
+        if (!str_value.empty()) {
+            auto [ptr, ec] = std::from_chars(str_value.data(), str_value.data() + str_value.size(), value);
+            if (ec == std::errc::invalid_argument) {
+                throw std::runtime_error("Invalid argument for number conversion from string.");
+            }
+            else if (ec == std::errc::result_out_of_range) {
+                throw std::runtime_error("Out of range for number conversion from string.");
+            }
+        }
+        return value;
+    }
+    
     //==========================================================
     // Convert a string to a bool
     template <typename T>
@@ -381,75 +1755,796 @@ namespace strutil {
         return false;
     }
     
+    //==========================================================
+    // Ingest number parsing: no exceptions, no allocation
+    //==========================================================
+    
+    //==========================================================
+    // Outcome of parse_number(), error is std::errc() on success,
+    // invalid_argument when there are no digits, result_out_of_range
+    // when the value does not fit T
+    template <typename T>
+    struct parsed_t {
+        T value{};
+        std::size_t used = 0;       // characters consumed
+        std::errc error = std::errc();
+        explicit operator bool() const { return error == std::errc(); }
+    };
+    
+    namespace detail {
+        //==========================================================
+        // Value of each character as a digit, 0xFF when it is not one
+        inline constexpr auto make_digit_table() -> std::array<std::uint8_t, 256> {
+            auto table = std::array<std::uint8_t, 256>{};
+            for (auto &entry : table) {
+                entry = 0xFF;
+            }
+            for (auto ch = 0; ch < 10; ++ch) {
+                table['0' + ch] = static_cast<std::uint8_t>(ch);
+            }
+            for (auto ch = 0; ch < 6; ++ch) {
+                table['a' + ch] = static_cast<std::uint8_t>(10 + ch);
+                table['A' + ch] = static_cast<std::uint8_t>(10 + ch);
+            }
+            return table;
+        }
+        inline constexpr auto digit_table = make_digit_table();
+        
+        //==========================================================
+        // Mask of the bytes of a little endian word that are not '0'-'9'
+        inline auto non_digits(std::uint64_t word) -> std::uint64_t {
+            constexpr auto ones = std::uint64_t(0x0101010101010101);
+            // A byte is a digit when its high nibble is 3 and adding 6 keeps it 3
+            return ((word & (0xF0 * ones)) ^ (0x30 * ones)) | (((word + 0x06 * ones) & (0xF0 * ones)) ^ (0x30 * ones));
+        }
+        //==========================================================
+        // The value of 8 ascii digits (first digit in the low byte)
+        inline auto eight_digits(std::uint64_t word) -> std::uint32_t {
+            word -= 0x3030303030303030;
+            word = (word * 10) + (word >> 8);
+            word = (((word & 0x000000FF000000FF) * (100 + (1000000ULL << 32))) + (((word >> 16) & 0x000000FF000000FF) * (1 + (10000ULL << 32)))) >> 32;
+            return static_cast<std::uint32_t>(word);
+        }
+        //==========================================================
+        // Unsigned decimal digits from the start of [data, data+length),
+        // stops at the first non digit. Returns false on overflow
+        inline auto parse_decimal(const char *data, std::size_t length, std::uint64_t &value, std::size_t &used) -> bool {
+            auto accumulated = std::uint64_t(0);
+            auto index = std::size_t(0);
+#if defined(STRUTIL_LITTLE_ENDIAN)
+            while (index + 8 <= length) {
+                auto word = std::uint64_t(0);
+                std::memcpy(&word, data + index, 8);
+                auto mask = non_digits(word);
+                auto count = (mask == 0) ? 8 : static_cast<std::size_t>(count_trailing_zeros(mask) / 8);
+                if (count == 0) {
+                    break;
+                }
+                if (count < 8) {
+                    // Right align the digits, '0' filling the front
+                    auto shift = 8 * (8 - count);
+                    word = (word << shift) | (0x3030303030303030 >> (64 - shift));
+                }
+                auto chunk = eight_digits(word);
+                auto scale = powers_of_ten[count];
+                if (accumulated > (std::numeric_limits<std::uint64_t>::max() - chunk) / scale) {
+                    return false;
+                }
+                accumulated = accumulated * scale + chunk;
+                index += count;
+                if (count < 8) {
+                    value = accumulated;
+                    used = index;
+                    return true;
+                }
+            }
+#endif
+            // Up to 19 digits can not overflow
+            auto unchecked = std::min<std::size_t>(length, 19);
+            for (; index < unchecked; ++index) {
+                auto digit = static_cast<unsigned>(static_cast<unsigned char>(data[index]) - '0');
+                if (digit > 9) {
+                    value = accumulated;
+                    used = index;
+                    return true;
+                }
+                accumulated = accumulated * 10 + digit;
+            }
+            for (; index < length; ++index) {
+                auto digit = static_cast<unsigned>(static_cast<unsigned char>(data[index]) - '0');
+                if (digit > 9) {
+                    break;
+                }
+                if (accumulated > (std::numeric_limits<std::uint64_t>::max() - digit) / 10) {
+                    return false;
+                }
+                accumulated = accumulated * 10 + digit;
+            }
+            value = accumulated;
+            used = index;
+            return true;
+        }
+        //==========================================================
+        // Digits of a power of two radix (bits per digit 1, 3 or 4)
+        inline auto parse_binary(const char *data, std::size_t length, int bits, std::uint64_t &value, std::size_t &used) -> bool {
+            auto accumulated = std::uint64_t(0);
+            auto limit = (std::uint64_t(1) << bits);
+            auto index = std::size_t(0);
+            for (; index < length; ++index) {
+                auto digit = static_cast<std::uint64_t>(digit_table[static_cast<unsigned char>(data[index])]);
+                if (digit >= limit) {
+                    break;
+                }
+                if ((accumulated >> (64 - bits)) != 0) {
+                    return false;
+                }
+                accumulated = (accumulated << bits) | digit;
+            }
+            value = accumulated;
+            used = index;
+            return true;
+        }
+    } // namespace detail
+    
+    //==========================================================
+    // Parses a number from the start of text (like from_chars: no leading
+    // whitespace or '+', a '-' only for signed types). Hex accepts an
+    // optional 0x, binary 0b and octal 0o. Decimal digits are taken
+    // 8 at a time where the text allows. Floating point types read
+    // fixed or scientific text, correctly rounded.
+    template <typename T>
+    auto parse_number(std::string_view text, radix_t radix = radix_t::dec) -> parsed_t<T> {
+        static_assert((std::is_integral_v<T> && !std::is_same_v<T, bool>) || std::is_floating_point_v<T>, "parse_number requires integral or floating point types");
+        auto rvalue = parsed_t<T>();
+        if constexpr (std::is_floating_point_v<T>) {
+            // from_chars rounds correctly, hex reads the digits of %a
+            auto format = (radix == radix_t::hex) ? std::chars_format::hex : std::chars_format::general;
+            auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), rvalue.value, format);
+            rvalue.error = ec;
+            rvalue.used = (ec == std::errc::invalid_argument) ? 0 : static_cast<std::size_t>(ptr - text.data());
+            return rvalue;
+        }
+        else {
+            auto index = std::size_t(0);
+            auto negative = false;
+            if constexpr (std::is_signed_v<T>) {
+                if (!text.empty() && (text[0] == '-')) {
+                    negative = true;
+                    index = 1;
+                }
+            }
+            if ((radix != radix_t::dec) && (text.size() - index > 2) && (text[index] == '0')) {
+                auto marker = static_cast<char>(text[index + 1] | 0x20);
+                if (((radix == radix_t::hex) && (marker == 'x')) || ((radix == radix_t::bin) && (marker == 'b')) || ((radix == radix_t::oct) && (marker == 'o'))) {
+                    index += 2;
+                }
+            }
+            auto magnitude = std::uint64_t(0);
+            auto digits = std::size_t(0);
+            auto fits = true;
+            switch (radix) {
+                case radix_t::hex:
+                    fits = detail::parse_binary(text.data() + index, text.size() - index, 4, magnitude, digits);
+                    break;
+                case radix_t::oct:
+                    fits = detail::parse_binary(text.data() + index, text.size() - index, 3, magnitude, digits);
+                    break;
+                case radix_t::bin:
+                    fits = detail::parse_binary(text.data() + index, text.size() - index, 1, magnitude, digits);
+                    break;
+                default:
+                    fits = detail::parse_decimal(text.data() + index, text.size() - index, magnitude, digits);
+                    break;
+            }
+            if (fits && (digits == 0)) {
+                rvalue.error = std::errc::invalid_argument;
+                return rvalue;
+            }
+            rvalue.used = index + digits;
+            if constexpr (std::is_signed_v<T>) {
+                using unsigned_t = std::make_unsigned_t<T>;
+                auto limit = static_cast<std::uint64_t>(std::numeric_limits<T>::max()) + (negative ? 1 : 0);
+                if (!fits || (magnitude > limit)) {
+                    rvalue.error = std::errc::result_out_of_range;
+                    return rvalue;
+                }
+                rvalue.value = negative ? static_cast<T>(static_cast<unsigned_t>(0) - static_cast<unsigned_t>(magnitude)) : static_cast<T>(magnitude);
+            }
+            else {
+                if (!fits || (magnitude > static_cast<std::uint64_t>(std::numeric_limits<T>::max()))) {
+                    rvalue.error = std::errc::result_out_of_range;
+                    return rvalue;
+                }
+                rvalue.value = static_cast<T>(magnitude);
+            }
+            return rvalue;
+        }
+    }
+    
+    //==========================================================
+    // Outcome of parse_column(), on an error count is the number of
+    // fields parsed before it and failed the index of the bad field
+    struct column_t {
+        std::size_t count = 0;
+        std::size_t failed = 0;
+        std::errc error = std::errc();
+        explicit operator bool() const { return error == std::errc(); }
+    };
+    //==========================================================
+    // Parses every sep delimited field of text (trimmed, as tokens() gives
+    // them) into output, which has room for capacity values. A field
+    // must be all number; running out of room is result_out_of_range
+    template <typename T>
+    auto parse_column(std::string_view text, char sep, T *output, std::size_t capacity, radix_t radix = radix_t::dec) -> column_t {
+        auto rvalue = column_t();
+        for (auto field : tokens(text, std::string_view(&sep, 1))) {
+            if (rvalue.count == capacity) {
+                rvalue.error = std::errc::result_out_of_range;
+                rvalue.failed = rvalue.count;
+                return rvalue;
+            }
+            auto number = parse_number<T>(field, radix);
+            if (number && (number.used != field.size())) {
+                number.error = std::errc::invalid_argument;
+            }
+            if (!number) {
+                rvalue.error = number.error;
+                rvalue.failed = rvalue.count;
+                return rvalue;
+            }
+            output[rvalue.count++] = number.value;
+        }
+        return rvalue;
+    }
+    //==========================================================
+    // parse_column() appending to a vector
+    template <typename T>
+    auto parse_column(std::string_view text, char sep, std::vector<T> &output, radix_t radix = radix_t::dec) -> column_t {
+        auto start = output.size();
+        // One field per separator, plus the last
+        output.resize(start + static_cast<std::size_t>(std::count(text.begin(), text.end(), sep)) + 1);
+        auto rvalue = parse_column(text, sep, output.data() + start, output.size() - start, radix);
+        output.resize(start + rvalue.count);
+        return rvalue;
+    }
+    
+    //==========================================================
+    // ISO-8601 / RFC-3339 timestamps, without the C library time
+    // functions (no locale, no time zone database, no mktime)
+    //==========================================================
+    
+    //==========================================================
+    // A system_clock time at nanosecond precision, whatever the
+    // precision of system_clock::time_point itself
+    using nanotime_t = std::chrono::time_point<std::chrono::system_clock, std::chrono::nanoseconds>;
+    
+    namespace detail {
+        //==========================================================
+        // Days since 1970-01-01 of a proleptic Gregorian date
+        // (H. Hinnant's days_from_civil)
+        inline constexpr auto days_from_civil(std::int64_t year, unsigned month, unsigned day) -> std::int64_t {
+            year -= (month <= 2) ? 1 : 0;
+            auto era = ((year >= 0) ? year : year - 399) / 400;
+            auto year_of_era = static_cast<unsigned>(year - era * 400);
+            auto day_of_year = (153 * ((month > 2) ? month - 3 : month + 9) + 2) / 5 + day - 1;
+            auto day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+            return era * 146097 + static_cast<std::int64_t>(day_of_era) - 719468;
+        }
+        //==========================================================
+        inline constexpr auto days_in_month(std::int64_t year, unsigned month) -> unsigned {
+            if (month == 2) {
+                return (((year % 4) == 0) && (((year % 100) != 0) || ((year % 400) == 0))) ? 29 : 28;
+            }
+            return ((month == 4) || (month == 6) || (month == 9) || (month == 11)) ? 30 : 31;
+        }
+        //==========================================================
+        // Two digits at data, bad collects a non digit
+        inline auto two_digits(const char *data, unsigned &bad) -> unsigned {
+            auto high = static_cast<unsigned>(static_cast<unsigned char>(data[0])) - '0';
+            auto low = static_cast<unsigned>(static_cast<unsigned char>(data[1])) - '0';
+            bad |= static_cast<unsigned>(high > 9) | static_cast<unsigned>(low > 9);
+            return high * 10 + low;
+        }
+    } // namespace detail
+    
+    //==========================================================
+    // Parses a timestamp from the start of text:
+    //     YYYY-MM-DD[(T|t| )hh:mm[:ss[(.|,)fraction]][Z|z|(+|-)hh[[:]mm]]]
+    // Fractions keep up to 9 digits (nanoseconds), further digits are
+    // read and dropped. A time without an offset is taken as UTC, a date
+    // alone is its midnight UTC. Seconds may be 60 (a leap second counts
+    // into the next minute). Errors are invalid_argument; used is where
+    // parsing stopped. nanotime_t covers 1677-09-21T00:12:43.145224192Z
+    // to 2262-04-11T23:47:16.854775807Z, a well formed time outside that
+    // is result_out_of_range (used then says where it ended).
+    inline auto parse_timestamp(std::string_view text) -> parsed_t<nanotime_t> {
+        auto rvalue = parsed_t<nanotime_t>();
+        auto data = text.data();
+        auto size = text.size();
+        rvalue.error = std::errc::invalid_argument;
+        if ((size < 10) || (data[4] != '-') || (data[7] != '-')) {
+            return rvalue;
+        }
+        auto bad = 0u;
+        auto year = static_cast<std::int64_t>(detail::two_digits(data, bad) * 100 + detail::two_digits(data + 2, bad));
+        auto month = detail::two_digits(data + 5, bad);
+        auto day = detail::two_digits(data + 8, bad);
+        if ((bad != 0) || (month < 1) || (month > 12) || (day < 1) || (day > detail::days_in_month(year, month))) {
+            return rvalue;
+        }
+        auto seconds = detail::days_from_civil(year, month, day) * 86400;
+        auto nanoseconds = std::int64_t(0);
+        auto index = std::size_t(10);
+        if ((size >= 16) && ((data[10] == 'T') || (data[10] == 't') || (data[10] == ' ')) && (data[13] == ':')) {
+            auto hour = detail::two_digits(data + 11, bad);
+            auto minute = detail::two_digits(data + 14, bad);
+            if ((bad != 0) || (hour > 23) || (minute > 59)) {
+                return rvalue;
+            }
+            seconds += hour * 3600 + minute * 60;
+            index = 16;
+            if ((size >= 19) && (data[16] == ':')) {
+                auto second = detail::two_digits(data + 17, bad);
+                if ((bad != 0) || (second > 60)) {
+                    return rvalue;
+                }
+                seconds += second;
+                index = 19;
+                if ((index < size) && ((data[index] == '.') || (data[index] == ','))) {
+                    auto start = ++index;
+                    auto fraction = std::int64_t(0);
+                    while ((index < size) && (static_cast<unsigned>(static_cast<unsigned char>(data[index]) - '0') < 10)) {
+                        if (index - start < 9) {
+                            fraction = fraction * 10 + (data[index] - '0');
+                        }
+                        ++index;
+                    }
+                    if (index == start) {
+                        return rvalue;
+                    }
+                    nanoseconds = fraction * static_cast<std::int64_t>(detail::powers_of_ten[9 - std::min<std::size_t>(index - start, 9)]);
+                }
+            }
+            if ((index < size) && ((data[index] == 'Z') || (data[index] == 'z'))) {
+                ++index;
+            }
+            else if ((index + 3 <= size) && ((data[index] == '+') || (data[index] == '-'))) {
+                auto sign = (data[index] == '-') ? -1 : 1;
+                auto offset_hours = detail::two_digits(data + index + 1, bad);
+                auto offset_minutes = 0u;
+                index += 3;
+                if ((index + 3 <= size) && (data[index] == ':')) {
+                    offset_minutes = detail::two_digits(data + index + 1, bad);
+                    index += 3;
+                }
+                else if ((index + 2 <= size) && (static_cast<unsigned>(static_cast<unsigned char>(data[index]) - '0') < 10)) {
+                    offset_minutes = detail::two_digits(data + index, bad);
+                    index += 2;
+                }
+                if ((bad != 0) || (offset_hours > 23) || (offset_minutes > 59)) {
+                    return rvalue;
+                }
+                // The local time is ahead of UTC by the offset
+                seconds -= sign * static_cast<std::int64_t>(offset_hours * 3600 + offset_minutes * 60);
+            }
+        }
+        rvalue.used = index;
+        // The first and last seconds of the range are only partly in it
+        constexpr auto highest = std::numeric_limits<std::int64_t>::max() / 1000000000;
+        constexpr auto lowest = std::numeric_limits<std::int64_t>::min() / 1000000000 - 1;
+        if ((seconds > highest) || (seconds < lowest) ||
+            ((seconds == highest) && (nanoseconds > std::numeric_limits<std::int64_t>::max() % 1000000000)) ||
+            ((seconds == lowest) && (nanoseconds < 1000000000 + std::numeric_limits<std::int64_t>::min() % 1000000000))) {
+            rvalue.error = std::errc::result_out_of_range;
+            return rvalue;
+        }
+        // Before the epoch, a whole second less and the fraction back off
+        // it, so the lowest second does not overflow on the way
+        auto total = (seconds < 0) ? (seconds + 1) * 1000000000 - (1000000000 - nanoseconds) : seconds * 1000000000 + nanoseconds;
+        rvalue.value = nanotime_t(std::chrono::nanoseconds(total));
+        rvalue.error = std::errc();
+        return rvalue;
+    }
+    //==========================================================
+    // parse_timestamp() on each of count views (whole view, surrounding
+    // whitespace allowed) into output, stopping at the first bad one
+    inline auto parse_timestamps(const std::string_view *texts, std::size_t count, nanotime_t *output) -> column_t {
+        auto rvalue = column_t();
+        for (; rvalue.count < count; ++rvalue.count) {
+            auto text = trim(texts[rvalue.count]);
+            auto time = parse_timestamp(text);
+            if (time && (time.used != text.size())) {
+                time.error = std::errc::invalid_argument;
+            }
+            if (!time) {
+                rvalue.error = time.error;
+                rvalue.failed = rvalue.count;
+                return rvalue;
+            }
+            output[rvalue.count] = time.value;
+        }
+        return rvalue;
+    }
+    
     //===========================================================
     // Formatted dump of a byte buffer
     //===========================================================
+    namespace detail {
+        //===========================================================
+        // Every byte's dump entry and the space after it, width characters each
+        template <std::size_t Width>
+        constexpr auto make_dump_table(int radix) -> std::array<char, 256 * Width> {
+            auto table = std::array<char, 256 * Width>{};
+            for (std::size_t value = 0; value < 256; ++value) {
+                auto remaining = value;
+                for (auto i = Width - 1; i-- > 0;) {
+                    table[value * Width + i] = "0123456789abcdef"[remaining % static_cast<std::size_t>(radix)];
+                    remaining /= static_cast<std::size_t>(radix);
+                }
+                table[value * Width + Width - 1] = ' ';
+            }
+            return table;
+        }
+        inline constexpr auto dump_hex = make_dump_table<3>(16);
+        inline constexpr auto dump_dec = make_dump_table<4>(10);
+        inline constexpr auto dump_oct = make_dump_table<4>(8);
+        inline constexpr auto dump_bin = make_dump_table<9>(2);
+        
+        //===========================================================
+        // Appends the dump to output, one whole line at a time
+        inline auto dump_lines(std::string &output, const std::uint8_t *buffer, std::size_t length, radix_t radix, int entries_line, std::size_t first_row, std::size_t rows, int address_chars) -> void {
+            auto table = dump_hex.data();
+            auto entry_size = std::size_t(2);
+            switch (radix) {
+                case radix_t::dec:
+                    table = dump_dec.data();
+                    entry_size = 3;
+                    break;
+                case radix_t::oct:
+                    table = dump_oct.data();
+                    entry_size = 3;
+                    break;
+                case radix_t::bin:
+                    table = dump_bin.data();
+                    entry_size = 8;
+                    break;
+                default:
+                    break;
+            }
+            auto per_line = static_cast<std::size_t>(entries_line);
+            auto line_size = static_cast<std::size_t>(address_chars) + 2 + per_line * (entry_size + 2) + 2;
+            auto start = output.size();
+            output.resize(start + rows * line_size);
+            auto out = output.data() + start;
+            for (auto row = first_row; row < first_row + rows; ++row) {
+                auto offset = row * per_line;
+                auto count = std::min(per_line, length - offset);
+                ntos(out, static_cast<std::size_t>(address_chars), offset, radix_t::dec, false, address_chars, ' ');
+                out += address_chars;
+                *out++ = ':';
+                *out++ = ' ';
+                auto bytes = buffer + offset;
+                for (std::size_t i = 0; i < count; ++i) {
+                    std::memcpy(out, table + bytes[i] * (entry_size + 1), entry_size + 1);
+                    out += entry_size + 1;
+                }
+                // A short last line is spaced out so its text lines up
+                std::memset(out, ' ', (per_line - count) * (entry_size + 1) + 1);
+                out += (per_line - count) * (entry_size + 1) + 1;
+                for (std::size_t i = 0; i < count; ++i) {
+                    auto ch = bytes[i];
+                    out[i] = (static_cast<unsigned char>((ch | 0x20) - 'a') < 26) ? static_cast<char>(ch) : '.';
+                }
+                std::memset(out + count, ' ', per_line - count);
+                out += per_line;
+                *out++ = '\n';
+            }
+            output.resize(static_cast<std::size_t>(out - output.data()));
+        }
+        //===========================================================
+        inline auto dump_header(std::string &output, radix_t radix, int entries_line, int address_chars) -> void {
+            auto entry_size = (radix == radix_t::hex) ? 2 : ((radix == radix_t::bin) ? 8 : 3);
+            output.append(static_cast<std::size_t>(address_chars) + 2, ' ');
+            std::array<char, 24> number;
+            for (auto i = 0; i < entries_line; ++i) {
+                output.append(number.data(), ntos(number.data(), number.size(), i, radix_t::dec, false, entry_size, ' '));
+                output += ' ';
+            }
+            output += '\n';
+        }
+    } // namespace detail
     
+    //===========================================================
+    // Appends the formatted dump of a byte buffer to output (see below)
+    inline auto dump(std::string &output, const std::uint8_t *buffer,
+                     std::size_t length, radix_t radix = radix_t::hex,
+                     int entries_line = 8) -> void {
+        auto per_line = static_cast<std::size_t>(entries_line);
+        auto rows = (length / per_line) + (((length % per_line) == 0) ? 0 : 1);
+        auto address_chars = static_cast<int>(ntos_size(rows * per_line));
+        detail::dump_header(output, radix, entries_line, address_chars);
+        detail::dump_lines(output, buffer, length, radix, entries_line, 0, rows, address_chars);
+    }
     //===========================================================
     // Dumps a byte buffer, formatted to a provided stream.
     // The entries_line indicate how many bytes to display per line.
+    // Lines are rendered from byte tables into a block that is reused,
+    // and the stream gets whole blocks
     inline auto dump(std::ostream &output, const std::uint8_t *buffer,
                      std::size_t length, radix_t radix = radix_t::hex,
                      int entries_line = 8) -> void {
-        // number of characters for entry
-        auto entry_size = 3; // decimal and octal
-        switch (static_cast<int>(radix)) {
-            case static_cast<int>(radix_t::hex):
-                entry_size = 2;
-                break;
-            case static_cast<int>(radix_t::bin):
-                entry_size = 8;
-                break;
-            default:
-                break;
+        auto per_line = static_cast<std::size_t>(entries_line);
+        auto rows = (length / per_line) + (((length % per_line) == 0) ? 0 : 1);
+        auto address_chars = static_cast<int>(ntos_size(rows * per_line));
+        auto block = std::string();
+        detail::dump_header(block, radix, entries_line, address_chars);
+        // About 64K of text at a time
+        auto rows_block = std::max<std::size_t>(1, 65536 / (per_line * 10 + 16));
+        block.reserve(rows_block * (static_cast<std::size_t>(address_chars) + 4 + per_line * 10));
+        for (std::size_t row = 0; row < rows; row += rows_block) {
+            detail::dump_lines(block, buffer, length, radix, entries_line, row, std::min(rows_block, rows - row), address_chars);
+            output.write(block.data(), static_cast<std::streamsize>(block.size()));
+            block.clear();
         }
-        auto num_rows =
-        (length / entries_line) + (((length % entries_line) == 0) ? 0 : 1);
-        // what is the largest number for the address ?
-        auto max_address_chars =
-        static_cast<int>((ntos(num_rows * entries_line)).size());
-        
-        // first write out the header
-        output << std::setw(max_address_chars + 2) << "" << std::setw(1);
-        for (auto i = 0; i < entries_line; ++i) {
-            output << ntos(i, radix_t::dec, false, entry_size, ' ') << " ";
+        if (!block.empty()) {
+            output.write(block.data(), static_cast<std::streamsize>(block.size()));
         }
-        output << "\n";
-        
-        // now we write out the values for each line
-        std::string text(entries_line, ' ');
+    }
+    
+    //===========================================================
+    // Hex and base64 codecs
+    // Spans are pointer and length; the util::buffer_t forms write at the
+    // buffer's position (growing it when expandable) and move it on
+    //===========================================================
+    namespace detail {
+        //===========================================================
+        // "00" to "ff", two characters per entry
+        inline constexpr auto make_hex_pairs() -> std::array<char, 512> {
+            auto table = std::array<char, 512>{};
+            for (auto value = 0; value < 256; ++value) {
+                table[2 * value] = "0123456789abcdef"[value >> 4];
+                table[2 * value + 1] = "0123456789abcdef"[value & 15];
+            }
+            return table;
+        }
+        inline constexpr auto hex_pairs = make_hex_pairs();
         
-        for (std::size_t i = 0; i < length; ++i) {
-            auto row = i / entries_line;
-            if (((i % static_cast<std::size_t>(entries_line) == 0) &&
-                 (i >= static_cast<std::size_t>(entries_line))) ||
-                (i == 0)) {
-                // This is a new line!
-                output << ntos(row * entries_line, radix_t::dec, false,
-                               max_address_chars, ' ')
-                << ": ";
-                text = std::string(entries_line, ' ');
-            }
-            output << ntos(buffer[i], radix, false, entry_size) << " ";
-            // If it is an alpha, we want to write it
-            if (std::isalpha(static_cast<int>(buffer[i])) != 0) {
-                // we want to write this to the string
-                text[(i % entries_line)] = buffer[i];
-            } else {
-                text[(i % entries_line)] = '.';
-            }
-            if (i % entries_line == entries_line - 1) {
-                output << " " << text << "\n";
-            }
-        }
-        // what if we had a partial last line, we need to figure that out
-        auto last_line_entry = length % entries_line;
-        if (last_line_entry != 0) {
-            // we need to put the number of leading spaces
-            output << std::setw(static_cast<int>((entries_line - last_line_entry) *
-                                                 (entry_size + 1)))
-            << "" << std::setw(1) << " " << text << "\n";
+        inline constexpr char base64_alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        //===========================================================
+        // Value of each base64 character, 0xFF when it is not one
+        inline constexpr auto make_base64_table() -> std::array<std::uint8_t, 256> {
+            auto table = std::array<std::uint8_t, 256>{};
+            for (auto &entry : table) {
+                entry = 0xFF;
+            }
+            for (auto i = 0; i < 64; ++i) {
+                table[static_cast<unsigned char>(base64_alphabet[i])] = static_cast<std::uint8_t>(i);
+            }
+            return table;
+        }
+        inline constexpr auto base64_table = make_base64_table();
+    } // namespace detail
+    
+    //===========================================================
+    // Writes 2 * length lower case hex digits to output, returns that
+    inline auto hex_encode(const std::uint8_t *data, std::size_t length, char *output) -> std::size_t {
+        auto index = std::size_t(0);
+#if defined(STRUTIL_SSSE3)
+        auto digits = _mm_setr_epi8('0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f');
+        auto nibble = _mm_set1_epi8(0x0F);
+        for (; index + 16 <= length; index += 16) {
+            auto bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + index));
+            auto high = _mm_shuffle_epi8(digits, _mm_and_si128(_mm_srli_epi16(bytes, 4), nibble));
+            auto low = _mm_shuffle_epi8(digits, _mm_and_si128(bytes, nibble));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(output + 2 * index), _mm_unpacklo_epi8(high, low));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(output + 2 * index + 16), _mm_unpackhi_epi8(high, low));
+        }
+#endif
+        for (; index < length; ++index) {
+            std::memcpy(output + 2 * index, detail::hex_pairs.data() + 2 * data[index], 2);
+        }
+        return 2 * length;
+    }
+    //===========================================================
+    // Reads text.size() / 2 bytes into output, false if the length is
+    // odd or a character is not a hex digit (either case)
+    inline auto hex_decode(std::string_view text, std::uint8_t *output) -> bool {
+        if ((text.size() % 2) != 0) {
+            return false;
+        }
+        auto data = text.data();
+        auto length = text.size() / 2;
+        auto index = std::size_t(0);
+#if defined(STRUTIL_SSSE3)
+        for (; index + 8 <= length; index += 8) {
+            auto chars = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + 2 * index));
+            auto digit = _mm_sub_epi8(chars, _mm_set1_epi8('0'));
+            auto is_digit = _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)), digit);
+            auto letter = _mm_sub_epi8(_mm_or_si128(chars, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+            auto is_letter = _mm_cmpeq_epi8(_mm_min_epu8(letter, _mm_set1_epi8(5)), letter);
+            if (_mm_movemask_epi8(_mm_or_si128(is_digit, is_letter)) != 0xFFFF) {
+                return false;
+            }
+            auto values = _mm_or_si128(_mm_and_si128(is_digit, digit), _mm_and_si128(is_letter, _mm_add_epi8(letter, _mm_set1_epi8(10))));
+            // Each pair becomes high * 16 + low
+            auto pairs = _mm_maddubs_epi16(values, _mm_set1_epi16(0x0110));
+            _mm_storel_epi64(reinterpret_cast<__m128i *>(output + index), _mm_packus_epi16(pairs, pairs));
+        }
+#endif
+        for (; index < length; ++index) {
+            auto high = detail::digit_table[static_cast<unsigned char>(data[2 * index])];
+            auto low = detail::digit_table[static_cast<unsigned char>(data[2 * index + 1])];
+            if ((high > 15) || (low > 15)) {
+                return false;
+            }
+            output[index] = static_cast<std::uint8_t>((high << 4) | low);
+        }
+        return true;
+    }
+    //===========================================================
+    inline auto hex_encode(const std::uint8_t *data, std::size_t length) -> std::string {
+        auto rvalue = std::string(2 * length, ' ');
+        hex_encode(data, length, rvalue.data());
+        return rvalue;
+    }
+    //===========================================================
+    template <typename Buffer>
+    auto hex_encode(Buffer &buffer, const std::uint8_t *data, std::size_t length) -> Buffer & {
+        hex_encode(data, length, detail::writable(buffer, 2 * length));
+        buffer.at(buffer.at() + 2 * length);
+        return buffer;
+    }
+    //===========================================================
+    // The buffer (its size, contents and position) only changes when all
+    // of text decodes: it is decoded aside (on the stack when short) and
+    // then copied in, growing the buffer by exactly what was decoded
+    template <typename Buffer>
+    auto hex_decode(Buffer &buffer, std::string_view text) -> bool {
+        std::array<std::uint8_t, 1024> local;
+        auto large = std::vector<std::uint8_t>();
+        auto bytes = local.data();
+        auto length = text.size() / 2;
+        if (length > local.size()) {
+            large.resize(length);
+            bytes = large.data();
+        }
+        if (!hex_decode(text, bytes)) {
+            return false;
+        }
+        if (length != 0) {
+            std::memcpy(detail::writable(buffer, length), bytes, length);
+        }
+        buffer.at(buffer.at() + length);
+        return true;
+    }
+    
+    //===========================================================
+    // Characters base64_encode() writes for length bytes (padded with =)
+    inline constexpr auto base64_size(std::size_t length) -> std::size_t {
+        return ((length + 2) / 3) * 4;
+    }
+    //===========================================================
+    // Writes length bytes as padded base64 (RFC 4648) to output, returns
+    // the characters written
+    inline auto base64_encode(const std::uint8_t *data, std::size_t length, char *output) -> std::size_t {
+        auto index = std::size_t(0);
+        auto out = output;
+#if defined(STRUTIL_SSSE3)
+        // 12 bytes become 16 characters, the load reads 16
+        for (; index + 16 <= length; index += 12) {
+            auto bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + index));
+            bytes = _mm_shuffle_epi8(bytes, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+            // Spread each 3 bytes over 4 bytes of 6 bits
+            auto high = _mm_mulhi_epu16(_mm_and_si128(bytes, _mm_set1_epi32(0x0FC0FC00)), _mm_set1_epi32(0x04000040));
+            auto low = _mm_mullo_epi16(_mm_and_si128(bytes, _mm_set1_epi32(0x003F03F0)), _mm_set1_epi32(0x01000010));
+            auto indices = _mm_or_si128(high, low);
+            // Offset from index to character by range: A-Z, a-z, 0-9, + and /
+            auto range = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+            range = _mm_or_si128(range, _mm_and_si128(_mm_cmpgt_epi8(_mm_set1_epi8(26), indices), _mm_set1_epi8(13)));
+            auto offsets = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out), _mm_add_epi8(_mm_shuffle_epi8(offsets, range), indices));
+            out += 16;
+        }
+#endif
+        for (; index + 3 <= length; index += 3) {
+            auto word = (static_cast<std::uint32_t>(data[index]) << 16) | (static_cast<std::uint32_t>(data[index + 1]) << 8) | data[index + 2];
+            *out++ = detail::base64_alphabet[(word >> 18) & 63];
+            *out++ = detail::base64_alphabet[(word >> 12) & 63];
+            *out++ = detail::base64_alphabet[(word >> 6) & 63];
+            *out++ = detail::base64_alphabet[word & 63];
+        }
+        if (index < length) {
+            auto word = static_cast<std::uint32_t>(data[index]) << 16;
+            if (index + 1 < length) {
+                word |= static_cast<std::uint32_t>(data[index + 1]) << 8;
+            }
+            *out++ = detail::base64_alphabet[(word >> 18) & 63];
+            *out++ = detail::base64_alphabet[(word >> 12) & 63];
+            *out++ = (index + 1 < length) ? detail::base64_alphabet[(word >> 6) & 63] : '=';
+            *out++ = '=';
+        }
+        return static_cast<std::size_t>(out - output);
+    }
+    //===========================================================
+    // Reads padded base64 into output (room for text.size() / 4 * 3),
+    // setting length to the bytes decoded. False if text is not
+    // padded base64
+    inline auto base64_decode(std::string_view text, std::uint8_t *output, std::size_t &length) -> bool {
+        length = 0;
+        if ((text.size() % 4) != 0) {
+            return false;
+        }
+        auto padding = std::size_t(0);
+        if (!text.empty() && (text.back() == '=')) {
+            padding = (text[text.size() - 2] == '=') ? 2 : 1;
+        }
+        auto data = reinterpret_cast<const unsigned char *>(text.data());
+        auto out = output;
+        auto full = (text.size() - padding) / 4 * 4;
+        for (std::size_t index = 0; index < full; index += 4) {
+            auto a = detail::base64_table[data[index]];
+            auto b = detail::base64_table[data[index + 1]];
+            auto c = detail::base64_table[data[index + 2]];
+            auto d = detail::base64_table[data[index + 3]];
+            if ((a | b | c | d) > 63) {
+                return false;
+            }
+            auto word = (static_cast<std::uint32_t>(a) << 18) | (static_cast<std::uint32_t>(b) << 12) | (static_cast<std::uint32_t>(c) << 6) | d;
+            *out++ = static_cast<std::uint8_t>(word >> 16);
+            *out++ = static_cast<std::uint8_t>(word >> 8);
+            *out++ = static_cast<std::uint8_t>(word);
+        }
+        if (padding != 0) {
+            auto a = detail::base64_table[data[full]];
+            auto b = detail::base64_table[data[full + 1]];
+            auto c = (padding == 1) ? detail::base64_table[data[full + 2]] : std::uint8_t(0);
+            if ((a | b | c) > 63) {
+                return false;
+            }
+            auto word = (static_cast<std::uint32_t>(a) << 18) | (static_cast<std::uint32_t>(b) << 12) | (static_cast<std::uint32_t>(c) << 6);
+            *out++ = static_cast<std::uint8_t>(word >> 16);
+            if (padding == 1) {
+                *out++ = static_cast<std::uint8_t>(word >> 8);
+            }
+        }
+        length = static_cast<std::size_t>(out - output);
+        return true;
+    }
+    //===========================================================
+    inline auto base64_encode(const std::uint8_t *data, std::size_t length) -> std::string {
+        auto rvalue = std::string(base64_size(length), ' ');
+        base64_encode(data, length, rvalue.data());
+        return rvalue;
+    }
+    //===========================================================
+    template <typename Buffer>
+    auto base64_encode(Buffer &buffer, const std::uint8_t *data, std::size_t length) -> Buffer & {
+        auto size = base64_size(length);
+        base64_encode(data, length, detail::writable(buffer, size));
+        buffer.at(buffer.at() + size);
+        return buffer;
+    }
+    //===========================================================
+    // As hex_decode() into a buffer: nothing changes unless all of text
+    // decodes, and the buffer grows by exactly the bytes decoded
+    template <typename Buffer>
+    auto base64_decode(Buffer &buffer, std::string_view text) -> bool {
+        std::array<std::uint8_t, 1024> local;
+        auto large = std::vector<std::uint8_t>();
+        auto bytes = local.data();
+        if (text.size() / 4 * 3 > local.size()) {
+            large.resize(text.size() / 4 * 3);
+            bytes = large.data();
+        }
+        auto length = std::size_t(0);
+        if (!base64_decode(text, bytes, length)) {
+            return false;
+        }
+        if (length != 0) {
+            std::memcpy(detail::writable(buffer, length), bytes, length);
         }
+        buffer.at(buffer.at() + length);
+        return true;
     }
     
 } // namespace strutil
@@ -13,9 +13,15 @@ using namespace std::string_literals;
 namespace util{
     
     //=================================================================================
+    // The text only changes once a second, so each thread keeps the last one it made
     auto timer_t::now() ->std::string {
-        std::stringstream msg;
+        thread_local std::time_t cached_time = -1 ;
+        thread_local std::string cached ;
         auto now_time = std::chrono::system_clock::to_time_t( std::chrono::system_clock::now() );
+        if (now_time == cached_time){
+            return cached ;
+        }
+        std::stringstream msg;
         struct tm buffer;
 #if defined(_WIN32)
         localtime_s( &buffer, &now_time );
@@ -24,8 +30,14 @@ namespace util{
         auto now_tm = localtime_r( &now_time, &buffer );
 #endif
         msg << std::put_time( now_tm, "%c" );
-        return msg.str();
+        cached = msg.str();
+        cached_time = now_time ;
+        return cached ;
      }
+    //=================================================================================
+    auto timer_t::ticks() ->std::int64_t {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
     
     
     //=================================================================================
@@ -57,6 +69,11 @@ namespace util{
         return std::chrono::duration_cast<std::chrono::milliseconds>(now - start_time).count();
        
     }
+    //=================================================================================
+    auto timer_t::elapsed_ns() const ->std::int64_t {
+        auto now = std::chrono::steady_clock::now();
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(now - start_time).count();
+    }
     
     //=================================================================================
     auto timer_t::expired() const ->bool{
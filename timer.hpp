@@ -14,12 +14,15 @@ namespace util {
         std::int64_t time_duration ;
     public:
         static auto now() ->std::string ;
+        // Nanoseconds on the monotonic (steady) clock, for sub-millisecond work
+        static auto ticks() ->std::int64_t ;
         timer_t();
         timer_t(std::int64_t milliseconds,bool block);
         auto time(std::int64_t milliseconds,bool block)->void;
 
         auto start() ->void ;
         auto elapsed() const ->std::int64_t ;
+        auto elapsed_ns() const ->std::int64_t ;
         auto expired() const ->bool;
         auto remaining() const -> std::int64_t ;
     };
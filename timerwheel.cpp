@@ -0,0 +1,255 @@
+//Copyright © 2023 Charles Kerr. All rights reserved.
+
+#include "timerwheel.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+
+using namespace std::string_literals;
+
+namespace util {
+    //=================================================================================
+    timerwheel_t::timerwheel_t():current(0),active(0),running(false){
+        heads.fill(npos);
+    }
+    //=================================================================================
+    timerwheel_t::~timerwheel_t() {
+        stop();
+    }
+
+    //=================================================================================
+    // Internal (access must be held)
+    //=================================================================================
+
+    //=================================================================================
+    auto timerwheel_t::lookup(id_t id) const ->std::uint32_t {
+        auto index = static_cast<std::uint32_t>(id & 0xFFFFFFFF);
+        auto generation = static_cast<std::uint32_t>(id >> 32);
+        if ((index < nodes.size()) && (nodes[index].generation == generation) && (nodes[index].slot != npos)){
+            return index ;
+        }
+        return npos ;
+    }
+    //=================================================================================
+    // Pick the level whose span covers the distance to the deadline, and the slot in it
+    auto timerwheel_t::link(std::uint32_t index) ->void {
+        auto &node = nodes[index] ;
+        auto deadline = std::max(node.deadline, current);
+        auto delta = deadline - current ;
+        auto level = std::size_t(0) ;
+        while ((level < levels-1) && (delta >= (std::int64_t(1) << (slot_bits*(level+1))))){
+            ++level ;
+        }
+        if (delta >= (std::int64_t(1) << (slot_bits*levels))){
+            // Beyond the wheel, park it in the furthest slot, it is re-filed when it cascades
+            deadline = current + (std::int64_t(1) << (slot_bits*levels)) - 1 ;
+        }
+        auto slot = static_cast<std::uint32_t>(level*slots + ((deadline >> (slot_bits*level)) & (slots-1)));
+        node.slot = slot ;
+        node.prev = npos ;
+        node.next = heads[slot] ;
+        if (node.next != npos){
+            nodes[node.next].prev = index ;
+        }
+        heads[slot] = index ;
+    }
+    //=================================================================================
+    auto timerwheel_t::unlink(std::uint32_t index) ->void {
+        auto &node = nodes[index] ;
+        if (node.prev != npos){
+            nodes[node.prev].next = node.next ;
+        }
+        else {
+            heads[node.slot] = node.next ;
+        }
+        if (node.next != npos){
+            nodes[node.next].prev = node.prev ;
+        }
+        node.slot = npos ;
+    }
+    //=================================================================================
+    auto timerwheel_t::release(std::uint32_t index) ->void {
+        auto &node = nodes[index] ;
+        node.callback = nullptr ;
+        node.generation = (node.generation == 0xFFFFFFFF) ? 1 : node.generation + 1 ;
+        free_nodes.push_back(index);
+        active-- ;
+    }
+    //=================================================================================
+    auto timerwheel_t::cascade(std::size_t level, std::size_t slot) ->void {
+        auto index = heads[level*slots + slot] ;
+        heads[level*slots + slot] = npos ;
+        while (index != npos){
+            auto next = nodes[index].next ;
+            link(index);
+            index = next ;
+        }
+    }
+    //=================================================================================
+    auto timerwheel_t::process(std::int64_t tick) ->void {
+        // Entering a new window of a level moves that slot down to the finer levels
+        for (auto level = std::size_t(1) ; (level < levels) && (((tick >> (slot_bits*(level-1))) & (slots-1)) == 0) ; ++level){
+            cascade(level, static_cast<std::size_t>((tick >> (slot_bits*level)) & (slots-1)));
+        }
+        auto slot = static_cast<std::size_t>(tick & (slots-1)) ;
+        auto index = heads[slot] ;
+        heads[slot] = npos ;
+        while (index != npos){
+            auto &node = nodes[index] ;
+            auto next = node.next ;
+            node.slot = npos ;
+            expiring.emplace_back((static_cast<id_t>(node.generation) << 32) | index, std::move(node.callback));
+            release(index);
+            index = next ;
+        }
+    }
+    //=================================================================================
+    // Runs the callbacks collected by process(), without the lock
+    auto timerwheel_t::expire() ->std::size_t {
+        auto batch = std::vector<std::pair<id_t,callback_t>>() ;
+        {
+            auto lock = std::lock_guard(access);
+            batch.swap(expiring);
+        }
+        for (auto &[id,callback] : batch){
+            if (callback){
+                callback(id);
+            }
+        }
+        auto count = batch.size();
+        batch.clear();
+        {
+            // Hand the storage back, so a steady state does not allocate
+            auto lock = std::lock_guard(access);
+            if (expiring.empty() && (expiring.capacity() < batch.capacity())){
+                expiring.swap(batch);
+            }
+        }
+        return count ;
+    }
+
+    //=================================================================================
+    // Scheduling
+    //=================================================================================
+
+    //=================================================================================
+    auto timerwheel_t::schedule(std::int64_t milliseconds, callback_t callback) ->id_t {
+        auto lock = std::lock_guard(access);
+        auto index = std::uint32_t(0) ;
+        if (!free_nodes.empty()){
+            index = free_nodes.back();
+            free_nodes.pop_back();
+        }
+        else {
+            if (nodes.size() == npos){
+                throw std::runtime_error("Timer wheel capacity has been reached: "s + std::to_string(nodes.size()));
+            }
+            index = static_cast<std::uint32_t>(nodes.size());
+            nodes.push_back(node_t{0,npos,npos,1,npos,nullptr});
+        }
+        auto &node = nodes[index] ;
+        node.deadline = clock.elapsed() + milliseconds ;
+        node.callback = std::move(callback);
+        link(index);
+        active++ ;
+        return (static_cast<id_t>(node.generation) << 32) | index ;
+    }
+    //=================================================================================
+    auto timerwheel_t::cancel(id_t id) ->bool {
+        auto lock = std::lock_guard(access);
+        auto index = lookup(id);
+        if (index == npos){
+            return false ;
+        }
+        unlink(index);
+        release(index);
+        return true ;
+    }
+    //=================================================================================
+    auto timerwheel_t::reschedule(id_t id, std::int64_t milliseconds) ->bool {
+        auto lock = std::lock_guard(access);
+        auto index = lookup(id);
+        if (index == npos){
+            return false ;
+        }
+        unlink(index);
+        nodes[index].deadline = clock.elapsed() + milliseconds ;
+        link(index);
+        return true ;
+    }
+
+    //=================================================================================
+    // Status
+    //=================================================================================
+
+    //=================================================================================
+    // A timer that has fired or been cancelled is expired, with nothing remaining
+    auto timerwheel_t::remaining(id_t id) const ->std::int64_t {
+        auto lock = std::lock_guard(access);
+        auto index = lookup(id);
+        if (index == npos){
+            return 0 ;
+        }
+        return nodes[index].deadline - clock.elapsed() ;
+    }
+    //=================================================================================
+    auto timerwheel_t::expired(id_t id) const ->bool {
+        return remaining(id) <= 0 ;
+    }
+    //=================================================================================
+    auto timerwheel_t::size() const ->std::size_t {
+        auto lock = std::lock_guard(access);
+        return active ;
+    }
+    //=================================================================================
+    auto timerwheel_t::elapsed() const ->std::int64_t {
+        return clock.elapsed();
+    }
+
+    //=================================================================================
+    // Advancing
+    //=================================================================================
+
+    //=================================================================================
+    auto timerwheel_t::advance() ->std::size_t {
+        return advance(clock.elapsed());
+    }
+    //=================================================================================
+    auto timerwheel_t::advance(std::int64_t until) ->std::size_t {
+        {
+            auto lock = std::lock_guard(access);
+            if (active == 0){
+                current = std::max(current, until + 1);
+            }
+            while ((current <= until) && (active > 0)){
+                process(current);
+                ++current ;
+            }
+            if (active == 0){
+                current = std::max(current, until + 1);
+            }
+        }
+        return expire();
+    }
+    //=================================================================================
+    auto timerwheel_t::start(std::int64_t tick) ->void {
+        if (running.exchange(true)){
+            return ;
+        }
+        runner = std::thread([this,tick](){
+            while (running.load()){
+                std::this_thread::sleep_for(std::chrono::milliseconds(std::max<std::int64_t>(tick,1)));
+                advance();
+            }
+        });
+    }
+    //=================================================================================
+    auto timerwheel_t::stop() ->void {
+        running.store(false);
+        if (runner.joinable()){
+            runner.join();
+        }
+    }
+}
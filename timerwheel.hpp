@@ -0,0 +1,88 @@
+//Copyright © 2023 Charles Kerr. All rights reserved.
+
+#ifndef timerwheel_hpp
+#define timerwheel_hpp
+
+#include <cstdint>
+#include <array>
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "timer.hpp"
+
+namespace util {
+    //=================================================================================
+    /* Hierarchical hashed timer wheel, for large numbers of timeouts.
+     Schedule/cancel/reschedule are O(1), advancing only touches the slots that come due.
+     Times are milliseconds, with the same meaning as timer_t::time()/remaining(), measured
+     from the wheel's own timer_t. Callbacks run with no lock held, so they may schedule,
+     cancel or reschedule (a cancel that races an expiry already in progress has no effect).
+     */
+    class timerwheel_t {
+    public:
+        using id_t = std::uint64_t ;
+        using callback_t = std::function<void(id_t)> ;
+        static constexpr id_t invalid = 0 ;
+    private:
+        static constexpr std::uint32_t npos = 0xFFFFFFFF ;
+        static constexpr int slot_bits = 6 ;
+        static constexpr std::size_t slots = std::size_t(1) << slot_bits ;
+        static constexpr std::size_t levels = 6 ;   // 2^36 ms, a bit more than two years
+
+        struct node_t {
+            std::int64_t deadline ;
+            std::uint32_t next ;
+            std::uint32_t prev ;
+            std::uint32_t generation ;
+            std::uint32_t slot ;    // npos when not in the wheel
+            callback_t callback ;
+        };
+
+        mutable std::mutex access ;
+        timer_t clock ;
+        std::int64_t current ;  // the next tick to be processed
+        std::size_t active ;
+        std::array<std::uint32_t, slots*levels> heads ;
+        std::vector<node_t> nodes ;
+        std::vector<std::uint32_t> free_nodes ;
+        std::vector<std::pair<id_t,callback_t>> expiring ;
+
+        std::thread runner ;
+        std::atomic<bool> running ;
+
+        auto lookup(id_t id) const ->std::uint32_t ;
+        auto link(std::uint32_t index) ->void ;
+        auto unlink(std::uint32_t index) ->void ;
+        auto release(std::uint32_t index) ->void ;
+        auto cascade(std::size_t level, std::size_t slot) ->void ;
+        auto process(std::int64_t tick) ->void ;
+        auto expire() ->std::size_t ;
+    public:
+        timerwheel_t() ;
+        ~timerwheel_t() ;
+        timerwheel_t(const timerwheel_t&) = delete ;
+        auto operator=(const timerwheel_t&) ->timerwheel_t& = delete ;
+
+        auto schedule(std::int64_t milliseconds, callback_t callback) ->id_t ;
+        [[maybe_unused]] auto cancel(id_t id) ->bool ;
+        [[maybe_unused]] auto reschedule(id_t id, std::int64_t milliseconds) ->bool ;
+
+        auto remaining(id_t id) const ->std::int64_t ;
+        auto expired(id_t id) const ->bool ;
+        auto size() const ->std::size_t ;
+        // Milliseconds since the wheel was created
+        auto elapsed() const ->std::int64_t ;
+
+        // Process everything due up to now (or up to the given elapsed time), returns the number fired
+        [[maybe_unused]] auto advance() ->std::size_t ;
+        [[maybe_unused]] auto advance(std::int64_t until) ->std::size_t ;
+
+        // Run advance() on a dedicated thread, every tick milliseconds
+        auto start(std::int64_t tick = 1) ->void ;
+        auto stop() ->void ;
+    };
+}
+#endif /* timerwheel_hpp */
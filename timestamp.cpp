@@ -0,0 +1,123 @@
+//Copyright © 2023 Charles Kerr. All rights reserved.
+
+#include "timestamp.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <ctime>
+#include <limits>
+
+namespace util {
+    namespace {
+        //=================================================================================
+        // The formatted second, one for local and one for utc
+        struct cache_t {
+            std::int64_t second = std::numeric_limits<std::int64_t>::min() ;
+            char datetime[19] ;     // 2023-03-02T14:05:09
+            char offset[7] ;        // Z or +01:00
+            std::size_t offset_size = 0 ;
+        };
+        //=================================================================================
+        auto digits(char *text, int value, int count) ->void {
+            for (auto i = count - 1 ; i >= 0 ; --i){
+                text[i] = static_cast<char>('0' + value % 10);
+                value /= 10 ;
+            }
+        }
+        //=================================================================================
+        auto refresh(cache_t &cache, std::int64_t second, bool utc) ->void {
+            auto now_time = static_cast<std::time_t>(second);
+            struct tm buffer;
+            auto offset = long(0) ;
+#if defined(_WIN32)
+            if (utc){
+                gmtime_s( &buffer, &now_time );
+            }
+            else {
+                localtime_s( &buffer, &now_time );
+                offset = static_cast<long>(_mkgmtime(&buffer) - now_time);
+            }
+#else
+            if (utc){
+                gmtime_r( &now_time, &buffer );
+            }
+            else {
+                localtime_r( &now_time, &buffer );
+                offset = buffer.tm_gmtoff ;
+            }
+#endif
+            digits(cache.datetime, buffer.tm_year + 1900, 4);
+            cache.datetime[4] = '-';
+            digits(cache.datetime + 5, buffer.tm_mon + 1, 2);
+            cache.datetime[7] = '-';
+            digits(cache.datetime + 8, buffer.tm_mday, 2);
+            cache.datetime[10] = 'T';
+            digits(cache.datetime + 11, buffer.tm_hour, 2);
+            cache.datetime[13] = ':';
+            digits(cache.datetime + 14, buffer.tm_min, 2);
+            cache.datetime[16] = ':';
+            digits(cache.datetime + 17, buffer.tm_sec, 2);
+            if (utc){
+                cache.offset[0] = 'Z';
+                cache.offset_size = 1 ;
+            }
+            else {
+                cache.offset[0] = (offset < 0) ? '-' : '+';
+                offset = std::abs(offset) / 60 ;
+                digits(cache.offset + 1, static_cast<int>(offset / 60), 2);
+                cache.offset[3] = ':';
+                digits(cache.offset + 4, static_cast<int>(offset % 60), 2);
+                cache.offset_size = 6 ;
+            }
+            cache.second = second ;
+        }
+    }
+
+    //=================================================================================
+    auto timestamp_t::format(char *text, std::size_t size, precision_t precision, bool utc) ->std::size_t {
+        return format(text, size, std::chrono::system_clock::now(), precision, utc);
+    }
+    //=================================================================================
+    auto timestamp_t::format(char *text, std::size_t size, const std::chrono::system_clock::time_point &time, precision_t precision, bool utc) ->std::size_t {
+        thread_local cache_t caches[2] ;
+        auto micro = std::chrono::duration_cast<std::chrono::microseconds>(time.time_since_epoch()).count();
+        auto second = micro / 1000000 ;
+        auto fraction = micro % 1000000 ;
+        if (fraction < 0){
+            fraction += 1000000 ;
+            second -= 1 ;
+        }
+        auto &cache = caches[utc ? 1 : 0] ;
+        if (cache.second != second){
+            refresh(cache, second, utc);
+        }
+        auto places = static_cast<std::size_t>(precision);
+        auto length = sizeof(cache.datetime) + (places > 0 ? places + 1 : 0) + cache.offset_size ;
+        if (size < length){
+            return 0 ;
+        }
+        std::copy(cache.datetime, cache.datetime + sizeof(cache.datetime), text);
+        auto position = sizeof(cache.datetime) ;
+        if (places > 0){
+            text[position++] = '.';
+            auto value = static_cast<int>(fraction);
+            if (places == 3){
+                value /= 1000 ;
+            }
+            digits(text + position, value, static_cast<int>(places));
+            position += places ;
+        }
+        std::copy(cache.offset, cache.offset + cache.offset_size, text + position);
+        return length ;
+    }
+    //=================================================================================
+    auto timestamp_t::format(buffer_t &buffer, precision_t precision, bool utc) ->buffer_t& {
+        return format(buffer, std::chrono::system_clock::now(), precision, utc);
+    }
+    //=================================================================================
+    auto timestamp_t::format(buffer_t &buffer, const std::chrono::system_clock::time_point &time, precision_t precision, bool utc) ->buffer_t& {
+        char text[max_size] ;
+        auto length = format(text, max_size, time, precision, utc);
+        return buffer.write<std::uint8_t>(reinterpret_cast<std::uint8_t*>(text), length);
+    }
+}
@@ -0,0 +1,33 @@
+//Copyright © 2023 Charles Kerr. All rights reserved.
+
+#ifndef timestamp_hpp
+#define timestamp_hpp
+
+#include <cstdint>
+#include <cstddef>
+#include <chrono>
+
+#include "buffer.hpp"
+
+namespace util {
+    //=================================================================================
+    /* ISO-8601 wall clock timestamps, for loggers that stamp every line.
+     The date/time part is formatted once per second into a per-thread cache, only the
+     sub-second digits are written per call. Nothing is allocated.
+     Local time is written with its offset (2023-03-02T14:05:09.123+01:00), utc with a Z.
+     */
+    class timestamp_t {
+    public:
+        enum class precision_t { seconds = 0, milliseconds = 3, microseconds = 6 };
+        // Largest text format() writes, 2023-03-02T14:05:09.123456+01:00
+        static constexpr std::size_t max_size = 32 ;
+
+        // Returns the number of characters written (no terminating null), 0 if size is too small
+        static auto format(char *text, std::size_t size, precision_t precision = precision_t::milliseconds, bool utc = false) ->std::size_t ;
+        static auto format(char *text, std::size_t size, const std::chrono::system_clock::time_point &time, precision_t precision = precision_t::milliseconds, bool utc = false) ->std::size_t ;
+        // Writes at the buffer's current position
+        [[maybe_unused]] static auto format(buffer_t &buffer, precision_t precision = precision_t::milliseconds, bool utc = false) ->buffer_t& ;
+        [[maybe_unused]] static auto format(buffer_t &buffer, const std::chrono::system_clock::time_point &time, precision_t precision = precision_t::milliseconds, bool utc = false) ->buffer_t& ;
+    };
+}
+#endif /* timestamp_hpp */
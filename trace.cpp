@@ -0,0 +1,232 @@
+//Copyright © 2023 Charles Kerr. All rights reserved.
+
+#include "trace.hpp"
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+using namespace std::string_literals;
+
+namespace util {
+    namespace {
+        //=================================================================================
+        struct event_t {
+            const char *name ;
+            std::int64_t timestamp ;
+            std::int64_t value ;   // duration for spans, the value for counters
+            std::uint32_t depth ;
+            char phase ;
+        };
+        //=================================================================================
+        // Events are appended by the owning thread only, count is published with release
+        // so the writer sees complete events without a lock
+        struct chunk_t {
+            static constexpr std::size_t capacity = 4096 ;
+            std::array<event_t,capacity> events ;
+            std::atomic<std::size_t> count{0} ;
+            std::atomic<chunk_t*> next{nullptr} ;
+        };
+        //=================================================================================
+        struct thread_buffer_t {
+            std::uint64_t tid ;
+            std::atomic<const char*> name{nullptr} ;
+            chunk_t *head ;
+            chunk_t *tail ;
+            std::uint32_t depth ;
+            thread_buffer_t(std::uint64_t id):tid(id),head(new chunk_t()),tail(head),depth(0){}
+            ~thread_buffer_t(){
+                auto chunk = head ;
+                while (chunk != nullptr){
+                    auto next = chunk->next.load(std::memory_order_relaxed);
+                    delete chunk ;
+                    chunk = next ;
+                }
+            }
+            auto record(const event_t &event) ->void {
+                auto count = tail->count.load(std::memory_order_relaxed);
+                if (count == chunk_t::capacity){
+                    auto chunk = new chunk_t() ;
+                    tail->next.store(chunk,std::memory_order_release);
+                    tail = chunk ;
+                    count = 0 ;
+                }
+                tail->events[count] = event ;
+                tail->count.store(count+1,std::memory_order_release);
+            }
+        };
+        //=================================================================================
+        // Buffers are owned by the registry, so events survive the thread that made them
+        struct registry_t {
+            std::mutex access ;
+            std::vector<std::shared_ptr<thread_buffer_t>> buffers ;
+            std::uint64_t next_tid = 1 ;
+            std::atomic<std::int64_t> origin{0} ;
+        };
+        auto registry() ->registry_t& {
+            static registry_t instance ;
+            return instance ;
+        }
+        //=================================================================================
+        auto local() ->thread_buffer_t& {
+            thread_local std::shared_ptr<thread_buffer_t> buffer ;
+            if (buffer == nullptr){
+                auto &reg = registry() ;
+                auto lock = std::lock_guard(reg.access);
+                buffer = std::make_shared<thread_buffer_t>(reg.next_tid++);
+                reg.buffers.push_back(buffer);
+            }
+            return *buffer ;
+        }
+        //=================================================================================
+        auto escape(std::ostream &output, const char *text) ->void {
+            for (auto ptr = text ; *ptr != 0 ; ++ptr){
+                switch (*ptr) {
+                    case '"':
+                        output << "\\\"";
+                        break;
+                    case '\\':
+                        output << "\\\\";
+                        break;
+                    default:
+                        if (static_cast<unsigned char>(*ptr) >= 0x20){
+                            output << *ptr ;
+                        }
+                        break;
+                }
+            }
+        }
+        //=================================================================================
+        // Chrome expects microseconds, we keep the nanoseconds as the fraction
+        auto micro(std::ostream &output, std::int64_t nanoseconds) ->void {
+            if (nanoseconds < 0){
+                output << '-';
+                nanoseconds = -nanoseconds ;
+            }
+            auto fraction = nanoseconds % 1000 ;
+            output << nanoseconds / 1000 << '.' << static_cast<char>('0' + fraction / 100) << static_cast<char>('0' + (fraction / 10) % 10) << static_cast<char>('0' + fraction % 10);
+        }
+    }
+
+    std::atomic<bool> trace_t::active{false} ;
+
+    //=================================================================================
+    auto trace_t::enable(bool value) ->void {
+        if (value){
+            std::int64_t unset = 0 ;
+            registry().origin.compare_exchange_strong(unset, timer_t::ticks());
+        }
+        active.store(value,std::memory_order_relaxed);
+    }
+    //=================================================================================
+    auto trace_t::thread_name(const char *name) ->void {
+        local().name.store(name,std::memory_order_release);
+    }
+    //=================================================================================
+    auto trace_t::instant(const char *name) ->void {
+        if (enabled()){
+            auto &buffer = local() ;
+            buffer.record(event_t{name,timer_t::ticks(),0,buffer.depth,'i'});
+        }
+    }
+    //=================================================================================
+    auto trace_t::counter(const char *name, std::int64_t value) ->void {
+        if (enabled()){
+            local().record(event_t{name,timer_t::ticks(),value,0,'C'});
+        }
+    }
+    //=================================================================================
+    auto trace_t::enter() ->void {
+        local().depth++ ;
+    }
+    //=================================================================================
+    auto trace_t::complete(const char *name, std::int64_t begin, std::int64_t end) ->void {
+        auto &buffer = local() ;
+        buffer.depth-- ;
+        buffer.record(event_t{name,begin,end - begin,buffer.depth,'X'});
+    }
+    //=================================================================================
+    auto trace_t::write(std::ostream &output) ->void {
+        auto &reg = registry() ;
+        auto lock = std::lock_guard(reg.access);
+        auto origin = reg.origin.load();
+        auto first = true ;
+        auto separator = [&first,&output](){
+            if (!first){
+                output << ",\n";
+            }
+            first = false ;
+        };
+        output << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+        for (const auto &buffer : reg.buffers){
+            auto name = buffer->name.load(std::memory_order_acquire);
+            if (name != nullptr){
+                separator();
+                output << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" << buffer->tid << ",\"args\":{\"name\":\"";
+                escape(output, name);
+                output << "\"}}";
+            }
+            for (auto chunk = buffer->head ; chunk != nullptr ; chunk = chunk->next.load(std::memory_order_acquire)){
+                auto count = chunk->count.load(std::memory_order_acquire);
+                for (std::size_t i = 0 ; i < count ; ++i){
+                    const auto &event = chunk->events[i] ;
+                    separator();
+                    output << "{\"ph\":\"" << event.phase << "\",\"name\":\"";
+                    escape(output, event.name);
+                    output << "\",\"pid\":1,\"tid\":" << buffer->tid << ",\"ts\":";
+                    micro(output, event.timestamp - origin);
+                    switch (event.phase) {
+                        case 'X':
+                            output << ",\"dur\":";
+                            micro(output, event.value);
+                            output << ",\"args\":{\"depth\":" << event.depth << "}";
+                            break;
+                        case 'C':
+                            output << ",\"args\":{\"value\":" << event.value << "}";
+                            break;
+                        case 'i':
+                            output << ",\"s\":\"t\"";
+                            break;
+                        default:
+                            break;
+                    }
+                    output << "}";
+                }
+            }
+        }
+        output << "\n]}\n";
+    }
+    //=================================================================================
+    auto trace_t::write(const std::filesystem::path &path) ->void {
+        auto output = std::ofstream(path.string());
+        if (!output.is_open()){
+            throw std::runtime_error("Unable to create: "s + path.string());
+        }
+        write(output);
+    }
+    //=================================================================================
+    auto trace_t::clear() ->void {
+        auto &reg = registry() ;
+        auto lock = std::lock_guard(reg.access);
+        auto iter = std::remove_if(reg.buffers.begin(), reg.buffers.end(), [](const std::shared_ptr<thread_buffer_t> &buffer){
+            // Only the registry holds it, the thread is gone
+            return buffer.use_count() == 1 ;
+        });
+        reg.buffers.erase(iter,reg.buffers.end());
+        for (auto &buffer : reg.buffers){
+            auto chunk = buffer->head->next.exchange(nullptr);
+            while (chunk != nullptr){
+                auto next = chunk->next.load(std::memory_order_relaxed);
+                delete chunk ;
+                chunk = next ;
+            }
+            buffer->head->count.store(0,std::memory_order_relaxed);
+            buffer->tail = buffer->head ;
+        }
+        reg.origin.store(active.load() ? timer_t::ticks() : 0);
+    }
+}
@@ -0,0 +1,68 @@
+//Copyright © 2023 Charles Kerr. All rights reserved.
+
+#ifndef trace_hpp
+#define trace_hpp
+
+#include <cstdint>
+#include <atomic>
+#include <filesystem>
+#include <ostream>
+
+#include "timer.hpp"
+
+namespace util {
+    //=================================================================================
+    /* Lightweight tracing, written out in the Chrome/Perfetto trace-event json format
+     (load the file in chrome://tracing or ui.perfetto.dev).
+     Each thread records into its own buffer, so recording takes no locks. Names must
+     be string literals (or otherwise outlive the trace), only the pointer is kept.
+     */
+    class trace_t {
+        static std::atomic<bool> active ;
+    public:
+        static auto enable(bool value) ->void ;
+        static auto enabled() ->bool { return active.load(std::memory_order_relaxed);}
+
+        // Name the calling thread in the trace output
+        static auto thread_name(const char *name) ->void ;
+        static auto instant(const char *name) ->void ;
+        static auto counter(const char *name, std::int64_t value) ->void ;
+
+        // Used by tracespan_t, times are from timer_t::ticks()
+        static auto enter() ->void ;
+        static auto complete(const char *name, std::int64_t begin, std::int64_t end) ->void ;
+
+        static auto write(std::ostream &output) ->void ;
+        static auto write(const std::filesystem::path &path) ->void ;
+        // Discard recorded events, only call when no thread is recording
+        static auto clear() ->void ;
+    };
+
+    //=================================================================================
+    // RAII span, records a complete event from construction to destruction
+    class tracespan_t {
+        const char *name ;
+        std::int64_t begin ;
+    public:
+        explicit tracespan_t(const char *name):name(nullptr),begin(0){
+            if (trace_t::enabled()){
+                this->name = name ;
+                trace_t::enter();
+                begin = timer_t::ticks();
+            }
+        }
+        ~tracespan_t(){
+            if (name != nullptr){
+                trace_t::complete(name, begin, timer_t::ticks());
+            }
+        }
+        tracespan_t(const tracespan_t&) = delete ;
+        auto operator=(const tracespan_t&) ->tracespan_t& = delete ;
+    };
+}
+
+#define UTIL_TRACE_CONCAT_(a,b) a##b
+#define UTIL_TRACE_CONCAT(a,b) UTIL_TRACE_CONCAT_(a,b)
+#define UTIL_TRACE_SPAN(name) util::tracespan_t UTIL_TRACE_CONCAT(trace_span_,__LINE__)(name)
+
+#endif /* trace_hpp */